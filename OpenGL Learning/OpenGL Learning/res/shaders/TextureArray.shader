@@ -0,0 +1,33 @@
+#shader vertex
+#version 330 core
+		
+layout(location = 0) in vec4 position;
+layout(location = 1) in vec2 texCoord;
+layout(location = 2) in float layer; //Per vertex, or per instance from a buffer with a divisor of 1
+
+out vec2 v_TexCoord;
+flat out float v_Layer;
+
+uniform mat4 u_MVP;
+		
+void main()
+{
+	gl_Position = u_MVP * position;
+	v_TexCoord = texCoord;
+	v_Layer = layer;
+};
+
+#shader fragment
+#version 330 core
+		
+layout(location = 0) out vec4 colour;
+
+in vec2 v_TexCoord;
+flat in float v_Layer;
+uniform sampler2DArray u_Textures;
+
+		
+void main()
+{
+	colour = texture(u_Textures, vec3(v_TexCoord, v_Layer));
+};
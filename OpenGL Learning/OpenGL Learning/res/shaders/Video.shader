@@ -0,0 +1,45 @@
+#shader vertex
+#version 330 core
+		
+layout(location = 0) in vec4 position;
+layout(location = 1) in vec2 texCoord;
+
+out vec2 v_TexCoord;
+
+uniform mat4 u_MVP;
+		
+void main()
+{
+	gl_Position = u_MVP * position;
+	v_TexCoord = texCoord;
+};
+
+#shader fragment
+#version 330 core
+		
+layout(location = 0) out vec4 colour;
+
+in vec2 v_TexCoord;
+
+uniform sampler2D u_Planes; //Y on top, U and V side by side below it, see VideoPlayer
+uniform vec2 u_LumaSize;
+
+		
+void main()
+{
+	//Video rows are stored top first, and each plane is sampled no closer than half a texel to its edge so
+	//filtering never picks up its neighbour
+	vec2 size = vec2(textureSize(u_Planes, 0));
+	vec2 chromaSize = ceil(u_LumaSize * 0.5);
+	vec2 coord = vec2(v_TexCoord.x, 1.0 - v_TexCoord.y);
+	vec2 luma = clamp(coord * u_LumaSize, vec2(0.5), u_LumaSize - 0.5);
+	vec2 chroma = clamp(coord * chromaSize, vec2(0.5), chromaSize - 0.5);
+
+	float y = texture(u_Planes, luma / size).r;
+	float u = texture(u_Planes, (chroma + vec2(0.0, u_LumaSize.y)) / size).r - 0.5;
+	float v = texture(u_Planes, (chroma + vec2(chromaSize.x, u_LumaSize.y)) / size).r - 0.5;
+
+	//BT.601 with studio range luma, which is what raw captures nearly always are
+	y = 1.164 * (y - 16.0 / 255.0);
+	colour = vec4(y + 1.596 * v, y - 0.392 * u - 0.813 * v, y + 2.017 * u, 1.0);
+};
@@ -0,0 +1,45 @@
+#shader vertex
+#version 330 core
+		
+layout(location = 0) in vec4 position;
+layout(location = 1) in vec2 texCoord;
+
+out vec2 v_TexCoord;
+
+uniform mat4 u_MVP;
+		
+void main()
+{
+	gl_Position = u_MVP * position;
+	v_TexCoord = texCoord;
+};
+
+#shader fragment
+#version 330 core
+		
+layout(location = 0) out vec4 colour;
+
+in vec2 v_TexCoord;
+
+uniform sampler2D u_PageCache;
+uniform sampler2DArray u_Indirection; //One layer per level, each texel maps a level 0 page to a cached page
+uniform vec2 u_VirtualSize;
+uniform float u_PageSize;
+uniform float u_CacheSize;
+uniform int u_MaxLevel;
+
+		
+void main()
+{
+	vec2 pixel = v_TexCoord * u_VirtualSize;
+	vec2 dx = dFdx(pixel), dy = dFdy(pixel);
+	int level = clamp(int(floor(0.5 * log2(max(dot(dx, dx), dot(dy, dy))))), 0, u_MaxLevel);
+
+	//The entry holds the cache slot and the level of the page that is actually resident, which can be coarser
+	ivec2 page = clamp(ivec2(pixel / u_PageSize), ivec2(0), textureSize(u_Indirection, 0).xy - 1);
+	vec3 entry = texelFetch(u_Indirection, ivec3(page, level), 0).xyz * 255.0;
+
+	vec2 local = fract(pixel / (u_PageSize * exp2(entry.z)));
+	vec2 uv = (entry.xy * (u_PageSize + 2.0) + 1.0 + local * u_PageSize) / u_CacheSize;
+	colour = texture(u_PageCache, uv);
+};
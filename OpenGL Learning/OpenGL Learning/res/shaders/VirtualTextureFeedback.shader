@@ -0,0 +1,39 @@
+#shader vertex
+#version 330 core
+		
+layout(location = 0) in vec4 position;
+layout(location = 1) in vec2 texCoord;
+
+out vec2 v_TexCoord;
+
+uniform mat4 u_MVP;
+		
+void main()
+{
+	gl_Position = u_MVP * position;
+	v_TexCoord = texCoord;
+};
+
+#shader fragment
+#version 330 core
+		
+layout(location = 0) out vec4 colour;
+
+in vec2 v_TexCoord;
+
+uniform vec2 u_VirtualSize;
+uniform float u_PageSize;
+uniform int u_MaxLevel;
+uniform float u_LevelBias; //Makes up for rendering the feedback at a lower resolution than the screen
+
+		
+void main()
+{
+	vec2 pixel = v_TexCoord * u_VirtualSize;
+	vec2 dx = dFdx(pixel), dy = dFdy(pixel);
+	int level = clamp(int(floor(0.5 * log2(max(dot(dx, dx), dot(dy, dy))) + u_LevelBias)), 0, u_MaxLevel);
+
+	//Page x and y get 12 bits each, the low 8 in red and green and the high 4 packed into blue. Alpha is level + 1
+	ivec2 page = max(ivec2(pixel / (u_PageSize * exp2(float(level)))), ivec2(0));
+	colour = vec4(float(page.x & 255), float(page.y & 255), float(((page.x >> 8) & 15) | (((page.y >> 8) & 15) << 4)), float(level + 1)) / 255.0;
+};
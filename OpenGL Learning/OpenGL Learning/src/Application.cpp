@@ -1,4 +1,3 @@
-#include <iostream>
 #include <fstream>
 
 #include "Renderer.h"
@@ -7,7 +6,21 @@
 #include "IndexBuffer.h"
 #include "VertexArray.h"
 #include "shader.h"
+#include "ShaderWatcher.h"
 #include "Texture.h"
+#include "TextureLoader.h"
+#include "TextureCache.h"
+#include "TiledImage.h"
+#include "VirtualTexture.h"
+#include "VideoPlayer.h"
+#include "BlockCompression.h"
+#include "RenderTargetPool.h"
+#include "HeadlessContext.h"
+#include "GpuProfiler.h"
+#include "CpuProfiler.h"
+#include "GLDebugOutput.h"
+#include "RenderStats.h"
+#include "Log.h"
 
 #include <glm/glm.hpp>
 #include <glm/gtc/matrix_transform.hpp>
@@ -18,10 +31,187 @@
 
 #include <glew.h>
 #include <GLFW/glfw3.h>
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+#include <vector>
 
+//Offline mode, compresses an image to a DDS without opening a window: --compress <input> <output.dds> [bc1|bc3|bc4|bc5]
+int CompressTexture(int argc, char** argv)
+{
+	if (argc < 4)
+	{
+		Log::Info("Usage: --compress <input> <output.dds> [bc1|bc3|bc4|bc5]");
+		return -1;
+	}
+
+	BlockFormat format = BlockFormat::BC3;
+	if (argc > 4)
+	{
+		if (strcmp(argv[4], "bc1") == 0) format = BlockFormat::BC1;
+		else if (strcmp(argv[4], "bc4") == 0) format = BlockFormat::BC4;
+		else if (strcmp(argv[4], "bc5") == 0) format = BlockFormat::BC5;
+		else if (strcmp(argv[4], "bc3") != 0)
+		{
+			Log::Error("Unknown block format {}!", argv[4]);
+			return -1;
+		}
+	}
+
+	return CompressImageFile(argv[2], argv[3], format) ? 0 : -1;
+}
+
+//Benchmark mode, draws the scene into a framebuffer without a window and reports the frame time:
+//--headless <frames> [width] [height] [output.ppm] [trace.json]. The last frame is written out for regression checks
+//and the CPU timeline of every frame can be written as a Chrome trace
+int RunHeadless(int argc, char** argv)
+{
+	if (argc < 3)
+	{
+		Log::Info("Usage: --headless <frames> [width] [height] [output.ppm] [trace.json]");
+		return -1;
+	}
+	const int frames = std::max(1, atoi(argv[2]));
+	const int width = argc > 3 ? std::max(1, atoi(argv[3])) : 1280;
+	const int height = argc > 4 ? std::max(1, atoi(argv[4])) : 720;
+	const char* outputPath = argc > 5 ? argv[5] : nullptr;
+	if (argc > 6)
+		CpuProfiler::Capture(argv[6], frames);
+
+	HeadlessContext context;
+	if (!context.Create(3, 3))
+		return -1;
+
+	//A GLX build of GLEW can't find a GLX display under EGL, but the core entry points are loaded before it checks
+	GLenum glewResult = glewInit();
+	if (glewResult != GLEW_OK && glewResult != GLEW_ERROR_NO_GLX_DISPLAY)
+	{
+		Log::Error("Glew Error!");
+		return -1;
+	}
+	GLClearError();
+	Log::Info("{} on {}", glGetString(GL_VERSION), glGetString(GL_RENDERER));
+
+	int result = 0;
+	{
+		GLDebugOutput debugOutput;
+
+		const float positions[] = {
+			0.f,   0.f,   0.f, 0.f,
+			100.f, 0.f,   1.f, 0.f,
+			100.f, 100.f, 1.f, 1.f,
+			0.f,   100.f, 0.f, 1.f
+		};
+		const unsigned int indices[] = { 0, 1, 2, 2, 3, 0 };
+
+		Renderer renderer;
+		renderer.SetBlendMode(BlendMode::Premultiplied);
+
+		Shader shader(EmbeddedShaderID::Basic);
+		VertexArray va;
+		VertexBuffer vb(positions, sizeof(positions));
+		VertexBufferLayout layout;
+		layout.Push<float>(2);
+		layout.Push<float>(2);
+		va.AddBuffer(vb, layout);
+		IndexBuffer ib(indices, 6);
+
+		TextureOptions options;
+		options.Mipmaps = TextureMipmaps::CPU;
+		options.Premultiply = true;
+		Texture texture("res/textures/marble.png", options);
+
+		//The target comes from the pool every frame the way a real pass would get it, after the first frame it is recycled
+		RenderTargetPool renderTargets;
+		const glm::mat4 proj = glm::ortho(0.f, (float)width, 0.f, (float)height, -1.0f, 1.0f);
+
+		shader.Bind();
+		shader.SetUniform1i("u_Texture", 0);
+		texture.Bind();
+		Framebuffer* framebuffer = nullptr;
+		GpuProfiler gpuProfiler;
+
+		//glFinish at both ends so the time covers the GPU's work and not just the queueing of it
+		GLCall(glFinish());
+		const auto start = std::chrono::steady_clock::now();
+		for (int frame = 0; frame < frames; frame++)
+		{
+			CpuProfiler::BeginFrame();
+			gpuProfiler.BeginFrame();
+			framebuffer = &renderTargets.Acquire(width, height);
+			framebuffer->Bind();
+			renderer.Clear();
+
+			//The quad sweeps diagonally across the target so every frame is different but deterministic
+			const float t = (float)frame / frames;
+			const glm::mat4 model = glm::translate(glm::mat4(1.f), glm::vec3(t * (width - 100.f), t * (height - 100.f), 0.f));
+			shader.SetUniformMat4f("u_MVP", proj * model);
+			gpuProfiler.BeginPass("Quad");
+			renderer.Draw(va, ib, shader);
+			gpuProfiler.EndPass();
+
+			framebuffer->UnBind();
+			renderTargets.Update();
+			gpuProfiler.EndFrame();
+			RenderStats::EndFrame();
+		}
+		GLCall(glFinish());
+		CpuProfiler::BeginFrame();
+		const double totalMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+		Log::Info("Rendered {} frames at {}x{} in {} ms ({} ms/frame)", frames, width, height, totalMs, totalMs / frames);
+		for (const GpuProfiler::PassStats& pass : gpuProfiler.GetStats())
+			Log::Info("  GPU {}: min {} avg {} max {} ms", pass.Name, pass.MinMs, pass.AverageMs, pass.MaxMs);
+		const RenderStats& stats = RenderStats::GetLastFrame();
+		Log::Info("  Last frame: {} draws, {} triangles, {} program / {} vertex array / {} texture binds, {} uniforms",
+			stats.DrawCalls, stats.Triangles, stats.ProgramBinds, stats.VertexArrayBinds, stats.TextureBinds, stats.UniformUploads);
+
+		if (outputPath)
+		{
+			//GL reads bottom row first and PPM is top row first, without alpha
+			std::vector<unsigned char> pixels;
+			framebuffer->ReadPixels(pixels);
+
+			std::ofstream file(outputPath, std::ios::binary);
+			file << "P6\n" << width << " " << height << "\n255\n";
+			for (int y = height - 1; y >= 0; y--)
+			{
+				for (int x = 0; x < width; x++)
+					file.write((const char*)pixels.data() + ((size_t)y * width + x) * 4, 3);
+			}
+			if (!file)
+			{
+				Log::Error("Failed to write {}!", outputPath);
+				result = -1;
+			}
+		}
+	}
+	return result;
+}
 
-int main(void)
+int main(int argc, char** argv)
 {
+	if (argc > 1 && strcmp(argv[1], "--compress") == 0)
+		return CompressTexture(argc, argv);
+	if (argc > 1 && strcmp(argv[1], "--headless") == 0)
+		return RunHeadless(argc, argv);
+
+	//Viewer mode, streams a huge image in tiles instead of drawing the usual scene: --view <image>
+	std::string viewPath;
+	if (argc > 2 && strcmp(argv[1], "--view") == 0)
+		viewPath = argv[2];
+
+	//Virtual texturing mode, draws a huge image through a fixed size page cache: --virtual <image>
+	std::string virtualPath;
+	if (argc > 2 && strcmp(argv[1], "--virtual") == 0)
+		virtualPath = argv[2];
+
+	//Video mode, plays an uncompressed 4:2:0 .y4m file streamed into a dynamic texture: --video <file.y4m>
+	std::string videoPath;
+	if (argc > 2 && strcmp(argv[1], "--video") == 0)
+		videoPath = argv[2];
+
     GLFWwindow* window;
 	float ViewWidth = 1280.f;
 	float ViewHeight = 720.f;
@@ -35,6 +225,10 @@ int main(void)
 	glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 3);
 	glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 3);
 	glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
+#if GL_CHECK_POLICY == GL_CHECK_FULL
+	//Some drivers only report warnings, or only report them synchronously, in a debug context
+	glfwWindowHint(GLFW_OPENGL_DEBUG_CONTEXT, GLFW_TRUE);
+#endif
 	
     /* Create a windowed mode window and its OpenGL context */
     window = glfwCreateWindow(ViewWidth, ViewHeight, "Hello World", NULL, NULL);
@@ -51,12 +245,15 @@ int main(void)
 	//This sets up GLEW 
 	if(glewInit() != GLEW_OK)
 	{
-		std::cout << "Glew Error!" << std::endl;
+		Log::Error("Glew Error!");
 	}
-	std::cout << glGetString(GL_VERSION) << std::endl;
+	Log::Info("{}", glGetString(GL_VERSION));
 
 	//This Scope to fix the application not terminating properly
 	{
+		//Errors and driver warnings come through a callback from here on rather than GLCall polling for them
+		GLDebugOutput debugOutput;
+
     	//Magic number values to have a cube be rendered to the screen
 		float Positions[] = {
 		 100.f,  100.f,  0.0f, 0.0f,
@@ -69,9 +266,14 @@ int main(void)
 		2,3,0
 	};
     	
-		//This enables blending
-    	GLCall(glEnable(GL_BLEND));
-		GLCall(glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA));
+		//Textures are premultiplied when they load, so alpha blended and additive sprites share one blend state
+    	Renderer renderer;
+    	renderer.SetBlendMode(BlendMode::Premultiplied);
+
+    	//Sets up the shader that will be used
+		Shader shader(EmbeddedShaderID::Basic);
+    	shader.Bind();
+    	shader.SetUniform4f("u_Colour", 0.7f, 0.3f, 0.5f, 1.0f);
 
 		//This code generates and binds a vertex array object and vertex buffer
     	VertexArray va;
@@ -80,6 +282,7 @@ int main(void)
     	VertexBufferLayout layout;
     	layout.Push<float>(2);
     	layout.Push<float>(2);
+    	layout.Validate(shader);
     	va.AddBuffer(vb, layout);
 
     	//Sets up the index buffer 
@@ -89,14 +292,16 @@ int main(void)
 		glm::mat4 proj = glm::ortho(0.f, ViewWidth, 0.f, ViewHeight,-1.0f,1.0f);
 		glm::mat4 view = glm::translate(glm::mat4(1.f), glm::vec3(-100, 0 ,0));
     	
-    	//Sets up the shader that will be used
-		Shader shader("res/shaders/Basic.shader");
-    	shader.Bind();
-    	shader.SetUniform4f("u_Colour", 0.7f, 0.3f, 0.5f, 1.0f);
-    	
 
-		Texture texture("res/textures/marble.png");
-		texture.Bind();
+    	//Textures are decoded on worker threads and show a placeholder until they've been uploaded,
+    	//the cache shares them between users and keeps them under a video memory budget
+    	TextureLoader textureLoader;
+    	TextureCache textureCache(textureLoader);
+    	TextureOptions textureOptions;
+    	textureOptions.Mipmaps = TextureMipmaps::CPU;
+    	textureOptions.Anisotropy = 8.0f;
+    	textureOptions.Premultiply = true;
+		TextureHandle texture = textureCache.Get("res/textures/marble.png", textureOptions);
     	shader.SetUniform1i("u_Texture", 0);
     	
 		//These unbinds the buffers
@@ -105,7 +310,67 @@ int main(void)
 		vb.UnBind();
 		ib.UnBind();
 
-    	Renderer renderer;
+    	//The tile pyramid is cut once next to the image and reused until the image changes
+    	std::unique_ptr<TiledImage> tiledImage;
+    	if (!viewPath.empty() && TilePyramid::Build(viewPath, viewPath + ".tiles"))
+    		tiledImage = std::make_unique<TiledImage>(viewPath + ".tiles");
+
+    	//Virtual texturing uses the same pyramid, drawn on a quad the size of the image
+    	std::unique_ptr<VirtualTexture> virtualTexture;
+    	std::unique_ptr<Shader> virtualShader, feedbackShader;
+    	std::unique_ptr<VertexArray> virtualVA;
+    	std::unique_ptr<VertexBuffer> virtualVB;
+    	if (!virtualPath.empty() && TilePyramid::Build(virtualPath, virtualPath + ".tiles"))
+    	{
+    		virtualTexture = std::make_unique<VirtualTexture>(virtualPath + ".tiles");
+    		virtualShader = std::make_unique<Shader>(EmbeddedShaderID::VirtualTexture);
+    		feedbackShader = std::make_unique<Shader>(EmbeddedShaderID::VirtualTextureFeedback);
+
+    		const float w = (float)virtualTexture->GetWidth(), h = (float)virtualTexture->GetHeight();
+    		const float imageQuad[] = {
+    			0.f, 0.f, 0.f, 0.f,
+    			w,   0.f, 1.f, 0.f,
+    			w,   h,   1.f, 1.f,
+    			0.f, h,   0.f, 1.f
+    		};
+    		virtualVA = std::make_unique<VertexArray>();
+    		virtualVB = std::make_unique<VertexBuffer>(imageQuad, (unsigned int)sizeof(imageQuad));
+    		virtualVA->AddBuffer(*virtualVB, layout);
+    		virtualVA->UnBind();
+    	}
+
+    	//Video frames go up through a ring of pixel buffers, so a new frame never waits on the last one's upload
+    	std::unique_ptr<VideoPlayer> videoPlayer;
+    	std::unique_ptr<Shader> videoShader;
+    	std::unique_ptr<VertexArray> videoVA;
+    	std::unique_ptr<VertexBuffer> videoVB;
+    	if (!videoPath.empty())
+    	{
+    		videoPlayer = std::make_unique<VideoPlayer>(videoPath);
+    		if (videoPlayer->IsOpen())
+    		{
+    			videoShader = std::make_unique<Shader>(EmbeddedShaderID::Video);
+
+    			const float w = (float)videoPlayer->GetWidth(), h = (float)videoPlayer->GetHeight();
+    			const float videoQuad[] = {
+    				0.f, 0.f, 0.f, 0.f,
+    				w,   0.f, 1.f, 0.f,
+    				w,   h,   1.f, 1.f,
+    				0.f, h,   0.f, 1.f
+    			};
+    			videoVA = std::make_unique<VertexArray>();
+    			videoVB = std::make_unique<VertexBuffer>(videoQuad, (unsigned int)sizeof(videoQuad));
+    			videoVA->AddBuffer(*videoVB, layout);
+    			videoVA->UnBind();
+    		}
+    		else
+    			videoPlayer.reset();
+    	}
+    	float zoom = 1.0f;
+
+    	//Reloads the shader when its file is saved, this has to be destroyed before the shader
+		ShaderWatcher shaderWatcher;
+    	shaderWatcher.Watch(shader);
 
     	//Sets up imgui
 		IMGUI_CHECKVERSION();
@@ -128,9 +393,28 @@ int main(void)
     	
 		float r = 0.0f;
 		float increment = 0.05f;
+		double lastTime = glfwGetTime();
+		float cpuFrameMs = 0.0f;
+
+		//Per pass GPU times, read back a few frames late so they never hold up the frame being drawn
+		GpuProfiler gpuProfiler;
+		CpuProfiler::SetThreadName("Main");
 		/* Loop until the user closes the window */
 		while (!glfwWindowShouldClose(window))
 		{
+			CpuProfiler::BeginFrame();
+			{
+				PROFILE_SCOPE("Update");
+				//Swaps in any shaders that have been recompiled since the last frame
+				shaderWatcher.Update();
+				textureLoader.Update();
+			}
+
+			const double time = glfwGetTime();
+			const float deltaTime = (float)(time - lastTime);
+			lastTime = time;
+			gpuProfiler.BeginFrame();
+
 		    /* Render here */
 			renderer.Clear();
 
@@ -140,11 +424,58 @@ int main(void)
 
 			glm::mat4 model = glm::translate(glm::mat4(1.f), translation);
 			glm::mat4 mvp = proj * view * model;
-				
-			shader.Bind();
-			shader.SetUniformMat4f("u_MVP", mvp);
-			
-			renderer.Draw(va, ib, shader);
+
+			{
+				PROFILE_SCOPE("Scene");
+				gpuProfiler.BeginPass("Scene");
+				if (tiledImage)
+				{
+					//Works out which part of the image is on screen by taking the window's corners back into image pixels
+					model = glm::scale(model, glm::vec3(zoom, zoom, 1.f));
+					glm::mat4 screenToImage = glm::inverse(view * model);
+					glm::vec4 min = screenToImage * glm::vec4(0.f, 0.f, 0.f, 1.f);
+					glm::vec4 max = screenToImage * glm::vec4(ViewWidth, ViewHeight, 0.f, 1.f);
+
+					tiledImage->Update(glm::vec4(min.x, min.y, max.x, max.y), 1.f / zoom);
+					tiledImage->Draw(renderer, shader, proj * view * model);
+				}
+				else if (virtualTexture)
+				{
+					model = glm::scale(model, glm::vec3(zoom, zoom, 1.f));
+					glm::mat4 imageMVP = proj * view * model;
+
+					//The same geometry drawn small first tells the virtual texture which pages it needs
+					gpuProfiler.BeginPass("Feedback");
+					virtualTexture->BeginFeedback(*feedbackShader, (int)ViewWidth, (int)ViewHeight);
+					feedbackShader->SetUniformMat4f("u_MVP", imageMVP);
+					renderer.Draw(*virtualVA, ib, *feedbackShader);
+					virtualTexture->EndFeedback();
+					gpuProfiler.EndPass();
+					virtualTexture->Update();
+
+					virtualTexture->Bind(*virtualShader);
+					virtualShader->SetUniformMat4f("u_MVP", imageMVP);
+					renderer.Draw(*virtualVA, ib, *virtualShader);
+				}
+				else if (videoPlayer)
+				{
+					videoPlayer->Update(deltaTime);
+
+					model = glm::scale(model, glm::vec3(zoom, zoom, 1.f));
+					videoPlayer->Bind(*videoShader);
+					videoShader->SetUniformMat4f("u_MVP", proj * view * model);
+					renderer.Draw(*videoVA, ib, *videoShader);
+				}
+				else
+				{
+					shader.Bind();
+					shader.SetUniformMat4f("u_MVP", mvp);
+					texture.Bind();
+
+					renderer.Draw(va, ib, shader);
+				}
+				gpuProfiler.EndPass();
+			}
 			
 			if (r > 1.0f)
 				increment = -0.01f;
@@ -154,25 +485,91 @@ int main(void)
 
 			//imgui window setup
 			{
+				PROFILE_SCOPE("ImGui");
 				ImGui::ShowDemoWindow(&show_demo_window);
 
 				static float f = 0.0f;
 				static int counter = 0;
 
 				ImGui::Begin("Debug Tools");                    
-				ImGui::SliderFloat3("Translation", &translation.x, 0.f, ViewWidth);
+				if (tiledImage || virtualTexture || videoPlayer)
+				{
+					ImGui::DragFloat2("Pan", &translation.x);
+					ImGui::SliderFloat("Zoom", &zoom, 0.001f, 8.f, "%.3f", 4.f);
+				}
+				if (tiledImage)
+					ImGui::Text("Image %d x %d, %d levels", tiledImage->GetWidth(), tiledImage->GetHeight(), tiledImage->GetLevelCount());
+				else if (virtualTexture)
+					ImGui::Text("Virtual texture %d x %d, %u / %u pages resident", virtualTexture->GetWidth(), virtualTexture->GetHeight(),
+						virtualTexture->GetResidentPageCount(), virtualTexture->GetPageCapacity());
+				else if (videoPlayer)
+					ImGui::Text("Video %d x %d, frame %d / %d at %.2f FPS", videoPlayer->GetWidth(), videoPlayer->GetHeight(),
+						videoPlayer->GetCurrentFrame() + 1, videoPlayer->GetFrameCount(), videoPlayer->GetFrameRate());
+				else
+					ImGui::SliderFloat3("Translation", &translation.x, 0.f, ViewWidth);
 
 				ImGui::Text("Application average %.3f ms/frame (%.1f FPS)", 1000.0f / ImGui::GetIO().Framerate, ImGui::GetIO().Framerate);
+
+				//The GPU side is the time between the frame's first and last timestamps, whichever side takes longer is holding the frame rate
+				const float gpuFrameMs = gpuProfiler.GetFrameMs();
+				ImGui::Text("CPU %.3f ms, GPU %.3f ms per frame (%s bound)", cpuFrameMs, gpuFrameMs, gpuFrameMs > cpuFrameMs ? "GPU" : "CPU");
+				if (ImGui::TreeNode("GPU passes"))
+				{
+					ImGui::Columns(4);
+					ImGui::Text("Pass"); ImGui::NextColumn();
+					ImGui::Text("Min ms"); ImGui::NextColumn();
+					ImGui::Text("Avg ms"); ImGui::NextColumn();
+					ImGui::Text("Max ms"); ImGui::NextColumn();
+					for (const GpuProfiler::PassStats& pass : gpuProfiler.GetStats())
+					{
+						ImGui::Text("%s", pass.Name.c_str()); ImGui::NextColumn();
+						ImGui::Text("%.3f", pass.MinMs); ImGui::NextColumn();
+						ImGui::Text("%.3f", pass.AverageMs); ImGui::NextColumn();
+						ImGui::Text("%.3f", pass.MaxMs); ImGui::NextColumn();
+					}
+					ImGui::Columns(1);
+					ImGui::TreePop();
+				}
+				//Writes the CPU timeline of the next frames for chrome://tracing or Perfetto
+				if (CpuProfiler::IsRecording())
+					ImGui::Text("Capturing trace...");
+				else if (ImGui::Button("Capture trace"))
+					CpuProfiler::Capture("trace.json", 10);
+
+				//What the previous frame asked of GL
+				const RenderStats& stats = RenderStats::GetLastFrame();
+				ImGui::Text("%u draws, %llu triangles, %u uniforms", stats.DrawCalls, stats.Triangles, stats.UniformUploads);
+				ImGui::Text("Binds: %u programs, %u vertex arrays, %u textures", stats.ProgramBinds, stats.VertexArrayBinds, stats.TextureBinds);
+				ImGui::Text("Uploaded %.1f KB to buffers, %.1f KB to textures", stats.BufferBytesUploaded / 1024.0f, stats.TextureBytesUploaded / 1024.0f);
+				ImGui::Text("Created %u buffers, %u textures", stats.BuffersCreated, stats.TexturesCreated);
+				ImGui::Text("Textures %u, %.1f / %.1f MB", textureCache.GetTextureCount(), textureCache.GetResidentBytes() / (1024.0f * 1024.0f), textureCache.GetBudget() / (1024.0f * 1024.0f));
+
+				//Every texture shares its sampler with the others filtered the same way, so this reaches all of them at once
+				int quality = (int)Sampler::GetQuality();
+				if (ImGui::Combo("Filtering", &quality, "Bilinear\0Trilinear\0Anisotropic\0"))
+					Sampler::SetQuality((SamplerQuality)quality);
 				ImGui::End();
 				
 				// Rendering
 				ImGui::Render();
+				gpuProfiler.BeginPass("ImGui");
 				ImGui_ImplOpenGL3_RenderDrawData(ImGui::GetDrawData());
+				gpuProfiler.EndPass();
 			}
 			
 			
-		    /* Swap front and back buffers */
-		    GLCall(glfwSwapBuffers(window));
+			textureCache.Update();
+			gpuProfiler.EndFrame();
+			RenderStats::EndFrame();
+
+			//Everything up to here is the CPU's work for the frame, the swap may wait on vsync or the GPU
+			cpuFrameMs = (float)((glfwGetTime() - time) * 1000.0);
+
+			{
+				PROFILE_SCOPE("Swap");
+			    /* Swap front and back buffers */
+			    GLCall(glfwSwapBuffers(window));
+			}
 
 		    /* Poll for and process events */
 		    GLCall(glfwPollEvents());
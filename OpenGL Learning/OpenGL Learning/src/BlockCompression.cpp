@@ -0,0 +1,527 @@
+#include "BlockCompression.h"
+#include "MipChain.h"
+#include "ImageDecoder.h"
+#include "Log.h"
+
+#include <glew.h>
+
+#include <algorithm>
+#include <cctype>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <thread>
+
+unsigned int GetBlockSize(BlockFormat format)
+{
+	return (format == BlockFormat::BC1 || format == BlockFormat::BC4) ? 8 : 16;
+}
+
+unsigned int GetGLInternalFormat(BlockFormat format, bool srgb)
+{
+	switch (format)
+	{
+		case BlockFormat::BC1: return srgb ? GL_COMPRESSED_SRGB_ALPHA_S3TC_DXT1_EXT : GL_COMPRESSED_RGBA_S3TC_DXT1_EXT;
+		case BlockFormat::BC3: return srgb ? GL_COMPRESSED_SRGB_ALPHA_S3TC_DXT5_EXT : GL_COMPRESSED_RGBA_S3TC_DXT5_EXT;
+		case BlockFormat::BC4: return GL_COMPRESSED_RED_RGTC1;
+		case BlockFormat::BC5: return GL_COMPRESSED_RG_RGTC2;
+		case BlockFormat::BC7: return srgb ? GL_COMPRESSED_SRGB_ALPHA_BPTC_UNORM : GL_COMPRESSED_RGBA_BPTC_UNORM;
+	}
+	return 0;
+}
+
+bool IsBlockFormatSupported(BlockFormat format, bool srgb)
+{
+	switch (format)
+	{
+		//The sRGB S3TC formats come from EXT_texture_sRGB rather than the S3TC extension itself
+		case BlockFormat::BC1:
+		case BlockFormat::BC3: return GLEW_EXT_texture_compression_s3tc && (!srgb || GLEW_EXT_texture_sRGB);
+		case BlockFormat::BC4:
+		case BlockFormat::BC5: return GLEW_VERSION_3_0 || GLEW_ARB_texture_compression_rgtc;
+		case BlockFormat::BC7: return GLEW_VERSION_4_2 || GLEW_ARB_texture_compression_bptc;
+	}
+	return false;
+}
+
+//Encoders, each takes a 4x4 block of RGBA8 texels
+
+static uint16_t PackRGB565(const float colour[3])
+{
+	int r = (int)(std::min(std::max(colour[0], 0.0f), 255.0f) * 31.0f / 255.0f + 0.5f);
+	int g = (int)(std::min(std::max(colour[1], 0.0f), 255.0f) * 63.0f / 255.0f + 0.5f);
+	int b = (int)(std::min(std::max(colour[2], 0.0f), 255.0f) * 31.0f / 255.0f + 0.5f);
+	return (uint16_t)((r << 11) | (g << 5) | b);
+}
+
+static void UnpackRGB565(uint16_t packed, int colour[3])
+{
+	colour[0] = ((packed >> 11) & 31) * 255 / 31;
+	colour[1] = ((packed >> 5) & 63) * 255 / 63;
+	colour[2] = (packed & 31) * 255 / 31;
+}
+
+//Range fit along the principal axis of the colours, always in the 4 colour mode so BC3 can use it too
+static void EncodeColourBlock(const unsigned char* texels, unsigned char* out)
+{
+	float mean[3] = {};
+	for (int i = 0; i < 16; i++)
+		for (int c = 0; c < 3; c++)
+			mean[c] += texels[i * 4 + c] / 16.0f;
+
+	float covariance[6] = {};
+	for (int i = 0; i < 16; i++)
+	{
+		float d[3] = { texels[i * 4] - mean[0], texels[i * 4 + 1] - mean[1], texels[i * 4 + 2] - mean[2] };
+		covariance[0] += d[0] * d[0]; covariance[1] += d[0] * d[1]; covariance[2] += d[0] * d[2];
+		covariance[3] += d[1] * d[1]; covariance[4] += d[1] * d[2]; covariance[5] += d[2] * d[2];
+	}
+
+	//A few rounds of power iteration are plenty for a 3x3 matrix
+	float axis[3] = { 1.0f, 1.0f, 1.0f };
+	for (int iteration = 0; iteration < 4; iteration++)
+	{
+		float next[3] = {
+			covariance[0] * axis[0] + covariance[1] * axis[1] + covariance[2] * axis[2],
+			covariance[1] * axis[0] + covariance[3] * axis[1] + covariance[4] * axis[2],
+			covariance[2] * axis[0] + covariance[4] * axis[1] + covariance[5] * axis[2] };
+		float length = std::max(std::max(std::abs(next[0]), std::abs(next[1])), std::abs(next[2]));
+		if (length < 1e-6f)
+			break;
+		for (int c = 0; c < 3; c++)
+			axis[c] = next[c] / length;
+	}
+
+	float minProjection = 1e30f, maxProjection = -1e30f;
+	for (int i = 0; i < 16; i++)
+	{
+		float projection = (texels[i * 4] - mean[0]) * axis[0] + (texels[i * 4 + 1] - mean[1]) * axis[1] + (texels[i * 4 + 2] - mean[2]) * axis[2];
+		minProjection = std::min(minProjection, projection);
+		maxProjection = std::max(maxProjection, projection);
+	}
+
+	float axisLength = axis[0] * axis[0] + axis[1] * axis[1] + axis[2] * axis[2];
+	float maxColour[3], minColour[3];
+	for (int c = 0; c < 3; c++)
+	{
+		float scale = axisLength > 0.0f ? axis[c] / axisLength : 0.0f;
+		maxColour[c] = mean[c] + maxProjection * scale;
+		minColour[c] = mean[c] + minProjection * scale;
+	}
+
+	uint16_t colour0 = PackRGB565(maxColour);
+	uint16_t colour1 = PackRGB565(minColour);
+	if (colour0 < colour1)
+		std::swap(colour0, colour1);
+
+	int palette[4][3];
+	UnpackRGB565(colour0, palette[0]);
+	UnpackRGB565(colour1, palette[1]);
+	for (int c = 0; c < 3; c++)
+	{
+		palette[2][c] = (2 * palette[0][c] + palette[1][c]) / 3;
+		palette[3][c] = (palette[0][c] + 2 * palette[1][c]) / 3;
+	}
+
+	uint32_t indices = 0;
+	if (colour0 != colour1)
+	{
+		for (int i = 0; i < 16; i++)
+		{
+			int best = 0, bestDistance = INT32_MAX;
+			for (int p = 0; p < 4; p++)
+			{
+				int dr = texels[i * 4] - palette[p][0], dg = texels[i * 4 + 1] - palette[p][1], db = texels[i * 4 + 2] - palette[p][2];
+				int distance = dr * dr + dg * dg + db * db;
+				if (distance < bestDistance)
+				{
+					bestDistance = distance;
+					best = p;
+				}
+			}
+			indices |= (uint32_t)best << (i * 2);
+		}
+	}
+
+	out[0] = colour0 & 0xFF; out[1] = colour0 >> 8;
+	out[2] = colour1 & 0xFF; out[3] = colour1 >> 8;
+	for (int i = 0; i < 4; i++)
+		out[4 + i] = (indices >> (i * 8)) & 0xFF;
+}
+
+//One channel with 8 interpolated values between the min and max of the block
+static void EncodeChannelBlock(const unsigned char* texels, int channel, unsigned char* out)
+{
+	int low = 255, high = 0;
+	for (int i = 0; i < 16; i++)
+	{
+		low = std::min(low, (int)texels[i * 4 + channel]);
+		high = std::max(high, (int)texels[i * 4 + channel]);
+	}
+
+	uint64_t indices = 0;
+	if (high != low)
+	{
+		for (int i = 0; i < 16; i++)
+		{
+			//Step 0 is the high endpoint and step 7 the low one, the block stores them as indices 0 and 1
+			int step = ((high - texels[i * 4 + channel]) * 7 + (high - low) / 2) / (high - low);
+			int index = step == 0 ? 0 : step == 7 ? 1 : step + 1;
+			indices |= (uint64_t)index << (i * 3);
+		}
+	}
+
+	out[0] = (unsigned char)high;
+	out[1] = (unsigned char)low;
+	for (int i = 0; i < 6; i++)
+		out[2 + i] = (indices >> (i * 8)) & 0xFF;
+}
+
+static void EncodeBlock(const unsigned char* texels, BlockFormat format, unsigned char* out)
+{
+	switch (format)
+	{
+		case BlockFormat::BC1:
+			EncodeColourBlock(texels, out);
+			break;
+		case BlockFormat::BC3:
+			EncodeChannelBlock(texels, 3, out);
+			EncodeColourBlock(texels, out + 8);
+			break;
+		case BlockFormat::BC4:
+			EncodeChannelBlock(texels, 0, out);
+			break;
+		case BlockFormat::BC5:
+			EncodeChannelBlock(texels, 0, out);
+			EncodeChannelBlock(texels, 1, out + 8);
+			break;
+		case BlockFormat::BC7:
+			break;
+	}
+}
+
+static void CompressLevel(const unsigned char* pixels, int width, int height, BlockFormat format, CompressedImage::Level& level)
+{
+	const int blocksWide = (width + 3) / 4;
+	const int blocksHigh = (height + 3) / 4;
+	const unsigned int blockSize = GetBlockSize(format);
+
+	level.Width = width;
+	level.Height = height;
+	level.Data.resize((size_t)blocksWide * blocksHigh * blockSize);
+
+	//Block rows are independent, so the threads just take every Nth one
+	auto encodeRows = [&](int first, int step)
+	{
+		unsigned char texels[16 * 4];
+		for (int by = first; by < blocksHigh; by += step)
+		{
+			for (int bx = 0; bx < blocksWide; bx++)
+			{
+				//Blocks hanging over the edge repeat the last row and column
+				for (int y = 0; y < 4; y++)
+				{
+					for (int x = 0; x < 4; x++)
+					{
+						int sx = std::min(bx * 4 + x, width - 1);
+						int sy = std::min(by * 4 + y, height - 1);
+						memcpy(texels + (y * 4 + x) * 4, pixels + ((size_t)sy * width + sx) * 4, 4);
+					}
+				}
+				EncodeBlock(texels, format, level.Data.data() + ((size_t)by * blocksWide + bx) * blockSize);
+			}
+		}
+	};
+
+	const int threadCount = (int)std::min<unsigned int>(std::max(1u, std::thread::hardware_concurrency()), (unsigned int)blocksHigh);
+	std::vector<std::thread> threads;
+	for (int i = 1; i < threadCount; i++)
+		threads.emplace_back(encodeRows, i, threadCount);
+	encodeRows(0, threadCount);
+	for (auto& thread : threads)
+		thread.join();
+}
+
+bool CompressImage(const unsigned char* pixels, int width, int height, BlockFormat format, bool mipmaps, CompressedImage& image)
+{
+	if (format == BlockFormat::BC7)
+	{
+		Log::Error("BC7 can't be encoded, use BC3 or an external encoder!");
+		return false;
+	}
+
+	image.Format = format;
+	image.SRGB = false;
+	image.Levels.clear();
+	image.Levels.emplace_back();
+	CompressLevel(pixels, width, height, format, image.Levels.back());
+
+	if (mipmaps)
+	{
+		//BC4 and BC5 are usually masks or normals rather than colour
+		bool srgb = format == BlockFormat::BC1 || format == BlockFormat::BC3;
+		MipChain chain = MipChain::Generate(pixels, width, height, 4, srgb);
+		for (const auto& level : chain.GetLevels())
+		{
+			image.Levels.emplace_back();
+			CompressLevel(level.Pixels.data(), level.Width, level.Height, format, image.Levels.back());
+		}
+	}
+	return true;
+}
+
+bool CompressImageFile(const std::string& input, const std::string& output, BlockFormat format, bool mipmaps)
+{
+	//Stored bottom row first like every other texture we upload
+	int width, height, bpp;
+	unsigned char* pixels = DecodeImageFile(input, width, height, bpp, 4);
+	if (!pixels)
+	{
+		Log::Error("Failed to load {}: {}", input, GetImageFailureReason());
+		return false;
+	}
+
+	CompressedImage image;
+	bool compressed = CompressImage(pixels, width, height, format, mipmaps, image);
+	FreeImagePixels(pixels);
+
+	return compressed && SaveDDS(output, image);
+}
+
+//Containers
+
+static std::vector<unsigned char> ReadFile(const std::string& path)
+{
+	std::ifstream stream(path, std::ios::binary | std::ios::ate);
+	if (!stream)
+		return {};
+
+	std::vector<unsigned char> data((size_t)stream.tellg());
+	stream.seekg(0);
+	stream.read((char*)data.data(), data.size());
+	return data;
+}
+
+static size_t GetLevelSize(BlockFormat format, int width, int height)
+{
+	return (size_t)((width + 3) / 4) * ((height + 3) / 4) * GetBlockSize(format);
+}
+
+static uint32_t MakeFourCC(const char* code)
+{
+	return (uint32_t)code[0] | ((uint32_t)code[1] << 8) | ((uint32_t)code[2] << 16) | ((uint32_t)code[3] << 24);
+}
+
+struct DDSPixelFormat
+{
+	uint32_t Size, Flags, FourCC, RGBBitCount, RBitMask, GBitMask, BBitMask, ABitMask;
+};
+
+struct DDSHeader
+{
+	uint32_t Size, Flags, Height, Width, PitchOrLinearSize, Depth, MipMapCount;
+	uint32_t Reserved1[11];
+	DDSPixelFormat PixelFormat;
+	uint32_t Caps, Caps2, Caps3, Caps4, Reserved2;
+};
+
+struct DDSHeaderDX10
+{
+	uint32_t DXGIFormat, ResourceDimension, MiscFlag, ArraySize, MiscFlags2;
+};
+
+bool LoadDDS(const std::string& path, CompressedImage& image)
+{
+	std::vector<unsigned char> file = ReadFile(path);
+	if (file.size() < 4 + sizeof(DDSHeader) || memcmp(file.data(), "DDS ", 4) != 0)
+	{
+		Log::Error("{} isn't a DDS file!", path);
+		return false;
+	}
+
+	DDSHeader header;
+	memcpy(&header, file.data() + 4, sizeof(header));
+	size_t offset = 4 + sizeof(header);
+
+	uint32_t fourCC = header.PixelFormat.FourCC;
+	image.SRGB = false;
+	if (fourCC == MakeFourCC("DXT1")) image.Format = BlockFormat::BC1;
+	else if (fourCC == MakeFourCC("DXT5")) image.Format = BlockFormat::BC3;
+	else if (fourCC == MakeFourCC("ATI1") || fourCC == MakeFourCC("BC4U")) image.Format = BlockFormat::BC4;
+	else if (fourCC == MakeFourCC("ATI2") || fourCC == MakeFourCC("BC5U")) image.Format = BlockFormat::BC5;
+	else if (fourCC == MakeFourCC("DX10") && file.size() >= offset + sizeof(DDSHeaderDX10))
+	{
+		DDSHeaderDX10 dx10;
+		memcpy(&dx10, file.data() + offset, sizeof(dx10));
+		offset += sizeof(dx10);
+
+		//The UNORM and SRGB variants of each DXGI format
+		switch (dx10.DXGIFormat)
+		{
+			case 71: case 72: image.Format = BlockFormat::BC1; break;
+			case 77: case 78: image.Format = BlockFormat::BC3; break;
+			case 80: image.Format = BlockFormat::BC4; break;
+			case 83: image.Format = BlockFormat::BC5; break;
+			case 98: case 99: image.Format = BlockFormat::BC7; break;
+			default:
+				Log::Error("{} uses unsupported DXGI format {}!", path, dx10.DXGIFormat);
+				return false;
+		}
+		image.SRGB = dx10.DXGIFormat == 72 || dx10.DXGIFormat == 78 || dx10.DXGIFormat == 99;
+	}
+	else
+	{
+		Log::Error("{} isn't BC1, BC3, BC4, BC5 or BC7 compressed!", path);
+		return false;
+	}
+
+	image.Levels.clear();
+	int width = header.Width, height = header.Height;
+	for (uint32_t i = 0; i < std::max(1u, header.MipMapCount); i++)
+	{
+		size_t size = GetLevelSize(image.Format, width, height);
+		if (offset + size > file.size())
+		{
+			Log::Error("{} is truncated!", path);
+			return false;
+		}
+
+		image.Levels.push_back({ width, height, std::vector<unsigned char>(file.begin() + offset, file.begin() + offset + size) });
+		offset += size;
+		width = std::max(1, width / 2);
+		height = std::max(1, height / 2);
+	}
+	return true;
+}
+
+bool LoadKTX2(const std::string& path, CompressedImage& image)
+{
+	static const unsigned char identifier[12] = { 0xAB, 'K', 'T', 'X', ' ', '2', '0', 0xBB, '\r', '\n', 0x1A, '\n' };
+
+	//The 64 bit SGD fields sit at offset 44 of the header, not 8 byte aligned, so they are read as pairs of 32 bit
+	//halves to keep the compiler from padding the struct past the 68 bytes on disk
+	struct Header
+	{
+		uint32_t VkFormat, TypeSize, PixelWidth, PixelHeight, PixelDepth, LayerCount, FaceCount, LevelCount, SupercompressionScheme;
+		uint32_t DFDByteOffset, DFDByteLength, KVDByteOffset, KVDByteLength;
+		uint32_t SGDByteOffset[2], SGDByteLength[2];
+	};
+	static_assert(sizeof(Header) == 68, "KTX2 header has to match the file layout");
+	struct LevelIndex
+	{
+		uint64_t ByteOffset, ByteLength, UncompressedByteLength;
+	};
+
+	std::vector<unsigned char> file = ReadFile(path);
+	if (file.size() < sizeof(identifier) + sizeof(Header) || memcmp(file.data(), identifier, sizeof(identifier)) != 0)
+	{
+		Log::Error("{} isn't a KTX2 file!", path);
+		return false;
+	}
+
+	Header header;
+	memcpy(&header, file.data() + sizeof(identifier), sizeof(header));
+	if (header.SupercompressionScheme != 0 || header.PixelDepth > 1 || header.LayerCount > 1 || header.FaceCount != 1)
+	{
+		Log::Error("{} is supercompressed, an array, a cube map or 3D, only plain 2D textures are supported!", path);
+		return false;
+	}
+
+	//VkFormat values, UNORM and SRGB variants of each
+	switch (header.VkFormat)
+	{
+		case 131: case 132: case 133: case 134: image.Format = BlockFormat::BC1; break;
+		case 137: case 138: image.Format = BlockFormat::BC3; break;
+		case 139: image.Format = BlockFormat::BC4; break;
+		case 141: image.Format = BlockFormat::BC5; break;
+		case 145: case 146: image.Format = BlockFormat::BC7; break;
+		default:
+			Log::Error("{} uses unsupported VkFormat {}!", path, header.VkFormat);
+			return false;
+	}
+	image.SRGB = header.VkFormat == 132 || header.VkFormat == 134 || header.VkFormat == 138 || header.VkFormat == 146;
+
+	image.Levels.clear();
+	const uint32_t levelCount = std::max(1u, header.LevelCount);
+	const size_t indexOffset = 80; //Identifier and header
+	if (indexOffset + levelCount * sizeof(LevelIndex) > file.size())
+		return false;
+
+	for (uint32_t i = 0; i < levelCount; i++)
+	{
+		LevelIndex index;
+		memcpy(&index, file.data() + indexOffset + i * sizeof(LevelIndex), sizeof(index));
+
+		int width = std::max(1, (int)header.PixelWidth >> i);
+		int height = std::max(1, (int)header.PixelHeight >> i);
+		if (index.ByteOffset + index.ByteLength > file.size() || index.ByteLength < GetLevelSize(image.Format, width, height))
+		{
+			Log::Error("{} is truncated!", path);
+			return false;
+		}
+
+		image.Levels.push_back({ width, height, std::vector<unsigned char>(file.begin() + index.ByteOffset, file.begin() + index.ByteOffset + index.ByteLength) });
+	}
+	return true;
+}
+
+static std::string GetExtension(const std::string& path)
+{
+	size_t dot = path.find_last_of('.');
+	if (dot == std::string::npos)
+		return "";
+
+	std::string extension = path.substr(dot);
+	std::transform(extension.begin(), extension.end(), extension.begin(), [](unsigned char c) { return (char)std::tolower(c); });
+	return extension;
+}
+
+bool IsCompressedImageFile(const std::string& path)
+{
+	const std::string extension = GetExtension(path);
+	return extension == ".dds" || extension == ".ktx2";
+}
+
+bool LoadCompressedImage(const std::string& path, CompressedImage& image)
+{
+	return GetExtension(path) == ".dds" ? LoadDDS(path, image) : LoadKTX2(path, image);
+}
+
+bool SaveDDS(const std::string& path, const CompressedImage& image)
+{
+	std::ofstream stream(path, std::ios::binary | std::ios::trunc);
+	if (!stream || image.Levels.empty())
+		return false;
+
+	const uint32_t DDSD_CAPS = 0x1, DDSD_HEIGHT = 0x2, DDSD_WIDTH = 0x4, DDSD_PIXELFORMAT = 0x1000, DDSD_MIPMAPCOUNT = 0x20000, DDSD_LINEARSIZE = 0x80000;
+	const uint32_t DDPF_FOURCC = 0x4, DDSCAPS_COMPLEX = 0x8, DDSCAPS_TEXTURE = 0x1000, DDSCAPS_MIPMAP = 0x400000;
+
+	DDSHeader header = {};
+	header.Size = sizeof(DDSHeader);
+	header.Flags = DDSD_CAPS | DDSD_HEIGHT | DDSD_WIDTH | DDSD_PIXELFORMAT | DDSD_MIPMAPCOUNT | DDSD_LINEARSIZE;
+	header.Width = image.GetWidth();
+	header.Height = image.GetHeight();
+	header.PitchOrLinearSize = (uint32_t)image.Levels[0].Data.size();
+	header.MipMapCount = (uint32_t)image.Levels.size();
+	header.PixelFormat.Size = sizeof(DDSPixelFormat);
+	header.PixelFormat.Flags = DDPF_FOURCC;
+	header.Caps = DDSCAPS_TEXTURE | (image.Levels.size() > 1 ? DDSCAPS_COMPLEX | DDSCAPS_MIPMAP : 0);
+
+	//BC7 and the sRGB variants only have a DXGI format, so they need the DX10 header
+	const bool dx10 = image.Format == BlockFormat::BC7 || image.SRGB;
+	const char* fourCC[] = { "DXT1", "DXT5", "ATI1", "ATI2", "DX10" };
+	header.PixelFormat.FourCC = MakeFourCC(dx10 ? "DX10" : fourCC[(int)image.Format]);
+
+	stream.write("DDS ", 4);
+	stream.write((const char*)&header, sizeof(header));
+	if (dx10)
+	{
+		const uint32_t formats[] = { 71, 77, 80, 83, 98 }; //BC1 ... BC7 UNORM, the SRGB variant is one higher
+		DDSHeaderDX10 dx10Header = { formats[(int)image.Format] + (image.SRGB ? 1u : 0u), 3, 0, 1, 0 }; //TEXTURE2D
+		stream.write((const char*)&dx10Header, sizeof(dx10Header));
+	}
+	for (const auto& level : image.Levels)
+		stream.write((const char*)level.Data.data(), level.Data.size());
+
+	return (bool)stream;
+}
@@ -0,0 +1,52 @@
+#pragma once
+
+#include <string>
+#include <vector>
+
+enum class BlockFormat
+{
+	BC1, //RGB, 4 bits per texel
+	BC3, //RGBA, 8 bits per texel
+	BC4, //R, 4 bits per texel
+	BC5, //RG, 8 bits per texel
+	BC7 //RGBA, 8 bits per texel, can be loaded but not encoded
+};
+
+//A block compressed image and its mip levels, as stored in a DDS or KTX2 file.
+//Rows are uploaded in the order they're stored, and since every texture we load is flipped to have
+//its bottom row first, files exported by other tools need their vertical flip option turned on.
+struct CompressedImage
+{
+	struct Level
+	{
+		int Width, Height;
+		std::vector<unsigned char> Data;
+	};
+
+	BlockFormat Format = BlockFormat::BC1;
+	bool SRGB = false; //BC1, BC3 and BC7 colour stored gamma encoded, GL linearises it before filtering
+	std::vector<Level> Levels;
+
+	inline int GetWidth() const { return Levels.empty() ? 0 : Levels[0].Width; }
+	inline int GetHeight() const { return Levels.empty() ? 0 : Levels[0].Height; }
+};
+
+unsigned int GetBlockSize(BlockFormat format);
+//The GL_COMPRESSED_SRGB_* variant when srgb is set, BC4 and BC5 don't have one
+unsigned int GetGLInternalFormat(BlockFormat format, bool srgb = false);
+bool IsBlockFormatSupported(BlockFormat format, bool srgb = false);
+
+bool LoadDDS(const std::string& path, CompressedImage& image);
+bool LoadKTX2(const std::string& path, CompressedImage& image);
+bool SaveDDS(const std::string& path, const CompressedImage& image);
+
+//Picks the container from the extension, .dds or .ktx2
+bool IsCompressedImageFile(const std::string& path);
+bool LoadCompressedImage(const std::string& path, CompressedImage& image);
+
+//Encodes tightly packed RGBA8 pixels on several threads, BC4 reads the red channel and BC5 red and green.
+//The mip chain comes from MipChain so it is filtered in linear space like uncompressed mipmaps.
+bool CompressImage(const unsigned char* pixels, int width, int height, BlockFormat format, bool mipmaps, CompressedImage& image);
+
+//Loads any image DecodeImageFile can read and writes it out as a DDS, returns false if either step fails
+bool CompressImageFile(const std::string& input, const std::string& output, BlockFormat format, bool mipmaps = true);
@@ -0,0 +1,124 @@
+#include "ComputeShader.h"
+#include "Renderer.h"
+#include "Texture.h"
+#include "Log.h"
+
+namespace {
+
+//The formats Texture allocates that glBindImageTexture also accepts, 0 when there is none
+unsigned int GetImageFormat(unsigned int internalFormat)
+{
+	switch (internalFormat)
+	{
+		case GL_R8: case GL_RG8: case GL_RGBA8: case GL_RGB10_A2: case GL_R11F_G11F_B10F:
+		case GL_R16F: case GL_RG16F: case GL_RGBA16F: case GL_R32F: case GL_RG32F: case GL_RGBA32F:
+			return internalFormat;
+		case GL_SRGB8_ALPHA8:
+			return GL_RGBA8;
+		default:
+			return 0;
+	}
+}
+
+}
+
+ComputeShader::ComputeShader(const std::string& filepath)
+	: Shader(filepath)
+{
+}
+
+ComputeShader::ComputeShader(EmbeddedShaderID id)
+	: Shader(id)
+{
+}
+
+std::unique_ptr<ComputeShader> ComputeShader::Create(const std::string& filepath)
+{
+	if (!IsSupported())
+	{
+		Log::Error("Compute shaders aren't supported by this context, not loading {}!", filepath);
+		return nullptr;
+	}
+	return std::unique_ptr<ComputeShader>(new ComputeShader(filepath));
+}
+
+std::unique_ptr<ComputeShader> ComputeShader::Create(EmbeddedShaderID id)
+{
+	if (!IsSupported())
+	{
+		Log::Error("Compute shaders aren't supported by this context, not loading {}!", GetEmbeddedShader(id).FilePath);
+		return nullptr;
+	}
+	return std::unique_ptr<ComputeShader>(new ComputeShader(id));
+}
+
+bool ComputeShader::IsSupported()
+{
+	return GLEW_VERSION_4_3 || GLEW_ARB_compute_shader;
+}
+
+void ComputeShader::Dispatch(unsigned int x, unsigned int y, unsigned int z) const
+{
+	Bind();
+	GLCall(glDispatchCompute(x, y, z));
+}
+
+void ComputeShader::DispatchThreads(unsigned int width, unsigned int height, unsigned int depth) const
+{
+	int size[3];
+	GetWorkGroupSize(size);
+
+	Dispatch((width + size[0] - 1) / size[0], (height + size[1] - 1) / size[1], (depth + size[2] - 1) / size[2]);
+}
+
+void ComputeShader::GetWorkGroupSize(int size[3]) const
+{
+	GLCall(glGetProgramiv(GetRendererID(), GL_COMPUTE_WORK_GROUP_SIZE, size));
+}
+
+void ComputeShader::BindStorageBuffer(unsigned int binding, const VertexBuffer& vb)
+{
+	GLCall(glBindBufferBase(GL_SHADER_STORAGE_BUFFER, binding, vb.GetRendererID()));
+}
+
+void ComputeShader::BindStorageBuffer(unsigned int binding, const IndexBuffer& ib)
+{
+	GLCall(glBindBufferBase(GL_SHADER_STORAGE_BUFFER, binding, ib.GetRendererID()));
+}
+
+bool ComputeShader::BindImage(unsigned int unit, const Texture& texture, unsigned int access, unsigned int format)
+{
+	if (format == 0)
+		format = GetImageFormat(texture.GetFormat());
+	if (format == 0)
+	{
+		Log::Error("Texture format {} can't be bound as an image, pass a format to reinterpret it as!", texture.GetFormat());
+		return false;
+	}
+
+	GLCall(glBindImageTexture(unit, texture.GetRendererID(), 0, GL_FALSE, 0, access, format));
+	return true;
+}
+
+void ComputeShader::Barrier(unsigned int barriers)
+{
+	GLCall(glMemoryBarrier(barriers));
+}
+
+//For storage buffers read by a later dispatch
+void ComputeShader::StorageBarrier()
+{
+	Barrier(GL_SHADER_STORAGE_BARRIER_BIT);
+}
+
+//For buffers written by a dispatch and then drawn as vertices or indices
+void ComputeShader::VertexBarrier()
+{
+	Barrier(GL_VERTEX_ATTRIB_ARRAY_BARRIER_BIT | GL_ELEMENT_ARRAY_BARRIER_BIT);
+}
+
+//For images written by a dispatch and then read as images or sampled as textures
+void ComputeShader::ImageBarrier()
+{
+	Barrier(GL_SHADER_IMAGE_ACCESS_BARRIER_BIT | GL_TEXTURE_FETCH_BARRIER_BIT);
+}
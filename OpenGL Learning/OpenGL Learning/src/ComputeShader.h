@@ -0,0 +1,47 @@
+#pragma once
+
+#include <memory>
+
+#include "shader.h"
+
+class VertexBuffer;
+class IndexBuffer;
+class Texture;
+
+//A program made from the #shader compute stage of a .shader file, needs GL 4.3 or ARB_compute_shader.
+//Made through Create, which checks for support before anything is compiled
+class ComputeShader : public Shader
+{
+private:
+	ComputeShader(const std::string& filepath);
+	ComputeShader(EmbeddedShaderID id);
+
+public:
+	//Null, after logging why, if the context can't run compute shaders
+	static std::unique_ptr<ComputeShader> Create(const std::string& filepath);
+	static std::unique_ptr<ComputeShader> Create(EmbeddedShaderID id);
+	static bool IsSupported();
+
+	//Binds the program and launches x * y * z work groups
+	void Dispatch(unsigned int x, unsigned int y = 1, unsigned int z = 1) const;
+	//Launches enough work groups to cover width * height * depth invocations
+	void DispatchThreads(unsigned int width, unsigned int height = 1, unsigned int depth = 1) const;
+
+	//The local_size declared in the shader
+	void GetWorkGroupSize(int size[3]) const;
+
+	//Buffers are bound to layout(std430, binding = n) blocks so the results can be drawn straight from them
+	static void BindStorageBuffer(unsigned int binding, const VertexBuffer& vb);
+	static void BindStorageBuffer(unsigned int binding, const IndexBuffer& ib);
+	//Binds level 0 of the texture to layout(binding = n) image2D uniforms, access is GL_READ_ONLY, GL_WRITE_ONLY or GL_READ_WRITE.
+	//A format of 0 uses the image format matching the texture's, another one reinterprets the texels and has to be the
+	//same size. sRGB textures are bound as GL_RGBA8 and read the encoded bytes, image loads ignore swizzles. Three
+	//channel and block compressed textures have no image format, those log an error and return false
+	static bool BindImage(unsigned int unit, const Texture& texture, unsigned int access, unsigned int format = 0);
+
+	//Barriers to call between a dispatch and whatever reads the data it wrote
+	static void Barrier(unsigned int barriers);
+	static void StorageBarrier();
+	static void VertexBarrier();
+	static void ImageBarrier();
+};
@@ -0,0 +1,162 @@
+#include "CpuProfiler.h"
+#include "Log.h"
+
+#include <chrono>
+#include <fstream>
+#include <mutex>
+#include <vector>
+
+std::atomic<bool> CpuProfiler::s_Recording(false);
+std::atomic<unsigned int> CpuProfiler::s_Capture(0);
+std::vector<CpuProfiler::ThreadBuffer*> CpuProfiler::s_Buffers;
+
+namespace
+{
+	std::mutex s_BuffersMutex;
+
+	//Only touched by the main thread
+	std::string s_CapturePath;
+	unsigned int s_FramesLeft = 0;
+	uint64_t s_CaptureStart = 0;
+	uint64_t s_FrameStart = 0;
+
+	void WriteEscaped(std::ostream& stream, const char* text)
+	{
+		for (; *text; text++)
+		{
+			if (*text == '"' || *text == '\\')
+				stream << '\\';
+			stream << *text;
+		}
+	}
+}
+
+uint64_t CpuProfiler::GetTime()
+{
+	return (uint64_t)std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+CpuProfiler::ThreadBuffer& CpuProfiler::GetThreadBuffer()
+{
+	thread_local ThreadBuffer* t_Buffer = nullptr;
+	if (!t_Buffer)
+	{
+		//Default initialised so the large event array isn't zeroed
+		ThreadBuffer* buffer = new ThreadBuffer;
+		buffer->Count.store(0);
+		buffer->Capture.store(0);
+
+		std::lock_guard<std::mutex> lock(s_BuffersMutex);
+		s_Buffers.push_back(buffer);
+		buffer->ThreadID = (unsigned int)s_Buffers.size();
+		t_Buffer = buffer;
+	}
+	return *t_Buffer;
+}
+
+void CpuProfiler::Record(const char* name, uint64_t start, uint64_t end)
+{
+	ThreadBuffer& buffer = GetThreadBuffer();
+	const unsigned int capture = s_Capture.load(std::memory_order_acquire);
+	if (buffer.Capture.load(std::memory_order_relaxed) != capture)
+	{
+		buffer.Count.store(0, std::memory_order_relaxed);
+		buffer.Capture.store(capture, std::memory_order_release);
+	}
+
+	const unsigned int count = buffer.Count.load(std::memory_order_relaxed);
+	if (count == EventsPerThread)
+		return;
+	buffer.Events[count] = { name, start, end };
+	buffer.Count.store(count + 1, std::memory_order_release);
+}
+
+void CpuProfiler::SetThreadName(const std::string& name)
+{
+	ThreadBuffer& buffer = GetThreadBuffer();
+	std::lock_guard<std::mutex> lock(s_BuffersMutex);
+	buffer.ThreadName = name;
+}
+
+void CpuProfiler::Capture(const std::string& path, unsigned int frameCount)
+{
+	if (s_Recording.load() || frameCount == 0)
+		return;
+
+	s_CapturePath = path;
+	s_FramesLeft = frameCount;
+	s_CaptureStart = GetTime();
+	s_FrameStart = 0;
+	s_Capture.fetch_add(1, std::memory_order_release);
+	s_Recording.store(true, std::memory_order_release);
+}
+
+void CpuProfiler::BeginFrame()
+{
+	if (!s_Recording.load(std::memory_order_relaxed))
+		return;
+
+	//The capture counts from the first whole frame
+	const uint64_t now = GetTime();
+	if (s_FrameStart)
+	{
+		Record("Frame", s_FrameStart, now);
+		if (--s_FramesLeft == 0)
+		{
+			s_Recording.store(false, std::memory_order_release);
+			s_FrameStart = 0;
+			if (WriteTrace(s_CapturePath))
+				Log::Info("Wrote trace {}", s_CapturePath);
+			else
+				Log::Error("Failed to write trace {}!", s_CapturePath);
+			return;
+		}
+	}
+	s_FrameStart = now;
+}
+
+bool CpuProfiler::WriteTrace(const std::string& path)
+{
+	std::ofstream file(path);
+	if (!file)
+		return false;
+
+	//Complete ("X") events in microseconds from the start of the capture, plus a name for each thread
+	const unsigned int capture = s_Capture.load(std::memory_order_acquire);
+	bool first = true;
+	file << std::fixed;
+	file.precision(3);
+	file << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n";
+
+	std::lock_guard<std::mutex> lock(s_BuffersMutex);
+	for (const ThreadBuffer* buffer : s_Buffers)
+	{
+		if (buffer->Capture.load(std::memory_order_acquire) != capture)
+			continue;
+
+		const unsigned int count = buffer->Count.load(std::memory_order_acquire);
+		for (unsigned int i = 0; i < count; i++)
+		{
+			const Event& event = buffer->Events[i];
+			if (event.Start < s_CaptureStart)
+				continue;
+			file << (first ? "" : ",\n") << "{\"name\":\"";
+			WriteEscaped(file, event.Name);
+			file << "\",\"ph\":\"X\",\"pid\":1,\"tid\":" << buffer->ThreadID
+				 << ",\"ts\":" << (event.Start - s_CaptureStart) / 1000.0
+				 << ",\"dur\":" << (event.End - event.Start) / 1000.0 << "}";
+			first = false;
+		}
+
+		if (!buffer->ThreadName.empty())
+		{
+			file << (first ? "" : ",\n") << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":" << buffer->ThreadID << ",\"args\":{\"name\":\"";
+			WriteEscaped(file, buffer->ThreadName.c_str());
+			file << "\"}}";
+			first = false;
+		}
+	}
+
+	file << "\n]}\n";
+	return (bool)file;
+}
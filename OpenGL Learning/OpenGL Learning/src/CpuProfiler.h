@@ -0,0 +1,84 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+//Times the enclosing scope on the CPU: PROFILE_SCOPE("Upload"). The name must outlive the capture, in practice
+//a string literal. Defining DISABLE_PROFILING compiles every scope out.
+#ifndef DISABLE_PROFILING
+#define PROFILE_CONCAT_INNER(a, b) a##b
+#define PROFILE_CONCAT(a, b) PROFILE_CONCAT_INNER(a, b)
+#define PROFILE_SCOPE(name) CpuProfileScope PROFILE_CONCAT(profileScope, __LINE__)(name)
+#else
+#define PROFILE_SCOPE(name)
+#endif
+
+//Records scopes from any thread into that thread's own buffer and writes them out as Chrome trace JSON, which
+//chrome://tracing and Perfetto both open. Nothing is recorded outside a capture, a scope then costs one atomic
+//load. Capture starts recording and the trace is written by the EndFrame that finishes the requested frames.
+class CpuProfiler
+{
+private:
+	struct Event
+	{
+		const char* Name;
+		uint64_t Start, End; //Nanoseconds on the steady clock
+	};
+
+	static const unsigned int EventsPerThread = 65536; //Events past this in one capture are dropped
+
+	//Only ever appended to by its own thread. Count is published with release so the exporter, reading with
+	//acquire once recording has stopped, sees every event before it
+	struct ThreadBuffer
+	{
+		Event Events[EventsPerThread];
+		std::atomic<unsigned int> Count;
+		std::atomic<unsigned int> Capture; //Capture the events belong to, the owning thread resets Count when it is stale
+		unsigned int ThreadID;
+		std::string ThreadName;
+	};
+
+	static std::atomic<bool> s_Recording;
+	static std::atomic<unsigned int> s_Capture;
+	static std::vector<ThreadBuffer*> s_Buffers; //Never freed, a thread that exits leaves its events for the exporter
+
+public:
+	//Starts recording and writes the trace to path once frameCount more frames have ended, does nothing if a
+	//capture is already running
+	static void Capture(const std::string& path, unsigned int frameCount);
+	static inline bool IsRecording() { return s_Recording.load(std::memory_order_relaxed); }
+
+	//Marks the start of a frame on the main thread, which ends the previous one and writes the trace after the last
+	static void BeginFrame();
+
+	//Names the calling thread in the trace
+	static void SetThreadName(const std::string& name);
+
+	static uint64_t GetTime();
+	static void Record(const char* name, uint64_t start, uint64_t end);
+
+private:
+	static ThreadBuffer& GetThreadBuffer();
+	static bool WriteTrace(const std::string& path);
+};
+
+class CpuProfileScope
+{
+private:
+	const char* m_Name;
+	uint64_t m_Start; //0 when the scope began outside a capture
+
+public:
+	CpuProfileScope(const char* name)
+		: m_Name(name), m_Start(CpuProfiler::IsRecording() ? CpuProfiler::GetTime() : 0) {}
+	~CpuProfileScope()
+	{
+		if (m_Start)
+			CpuProfiler::Record(m_Name, m_Start, CpuProfiler::GetTime());
+	}
+
+	CpuProfileScope(const CpuProfileScope&) = delete;
+	CpuProfileScope& operator=(const CpuProfileScope&) = delete;
+};
@@ -0,0 +1,132 @@
+#include "DynamicTexture.h"
+#include "GLDebugOutput.h"
+#include "Log.h"
+#include "RenderStats.h"
+
+#include <cstring>
+
+DynamicTexture::DynamicTexture(int width, int height, int channels, int bufferCount)
+	: m_Channels(channels), m_PixelBuffers(bufferCount), m_Fences(bufferCount, nullptr), m_BufferSize((size_t)width * height * channels),
+	  m_NextBuffer(0), m_Mapped(nullptr), m_MappedUsed(0)
+{
+	TextureOptions options;
+	options.Channels = channels;
+	m_Texture = std::make_unique<Texture>(width, height, nullptr, options);
+
+	//Room for a little padding per region on top of a whole texture
+	m_BufferSize += 256;
+	GLCall(glGenBuffers(bufferCount, m_PixelBuffers.data()));
+	RenderStats::Current().BuffersCreated += bufferCount;
+	for (unsigned int buffer : m_PixelBuffers)
+	{
+		GLCall(glBindBuffer(GL_PIXEL_UNPACK_BUFFER, buffer));
+		GLCall(glBufferData(GL_PIXEL_UNPACK_BUFFER, m_BufferSize, nullptr, GL_STREAM_DRAW));
+		GLDebugOutput::SetLabel(GL_BUFFER, buffer, "DynamicTexture upload buffer");
+	}
+	GLCall(glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0));
+}
+
+DynamicTexture::~DynamicTexture()
+{
+	if (m_Mapped)
+		EndUpdate();
+
+	for (GLsync fence : m_Fences)
+	{
+		if (fence)
+		{
+			GLCall(glDeleteSync(fence));
+		}
+	}
+	GLCall(glDeleteBuffers((int)m_PixelBuffers.size(), m_PixelBuffers.data()));
+}
+
+bool DynamicTexture::BeginUpdate()
+{
+	if (m_Mapped)
+		return true;
+
+	GLsync& fence = m_Fences[m_NextBuffer];
+	if (fence)
+	{
+		//A zero timeout only asks, the flush makes sure the fence actually reaches the GPU
+		GLCall(unsigned int result = glClientWaitSync(fence, GL_SYNC_FLUSH_COMMANDS_BIT, 0));
+		if (result == GL_TIMEOUT_EXPIRED)
+			return false;
+		GLCall(glDeleteSync(fence));
+		fence = nullptr;
+	}
+
+	//The fence has passed so nothing can still be reading the buffer, there is no need for the driver to check again
+	GLCall(glBindBuffer(GL_PIXEL_UNPACK_BUFFER, m_PixelBuffers[m_NextBuffer]));
+	GLCall(m_Mapped = (unsigned char*)glMapBufferRange(GL_PIXEL_UNPACK_BUFFER, 0, m_BufferSize, GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_BUFFER_BIT | GL_MAP_UNSYNCHRONIZED_BIT));
+	GLCall(glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0));
+	if (!m_Mapped)
+	{
+		Log::Error("Failed to map a dynamic texture's pixel buffer!");
+		return false;
+	}
+
+	m_MappedUsed = 0;
+	m_Regions.clear();
+	return true;
+}
+
+unsigned char* DynamicTexture::MapRegion(int x, int y, int width, int height)
+{
+	if (!m_Mapped || x < 0 || y < 0 || x + width > GetWidth() || y + height > GetHeight())
+		return nullptr;
+
+	//Regions start 16 byte aligned so copies into them stay on the fast path
+	const size_t offset = (m_MappedUsed + 15) & ~(size_t)15;
+	const size_t size = (size_t)width * height * m_Channels;
+	if (offset + size > m_BufferSize)
+		return nullptr;
+
+	m_MappedUsed = offset + size;
+	m_Regions.push_back({ x, y, width, height, offset });
+	return m_Mapped + offset;
+}
+
+bool DynamicTexture::UpdateRegion(int x, int y, int width, int height, const unsigned char* pixels)
+{
+	unsigned char* destination = MapRegion(x, y, width, height);
+	if (!destination)
+		return false;
+	memcpy(destination, pixels, (size_t)width * height * m_Channels);
+	return true;
+}
+
+void DynamicTexture::EndUpdate()
+{
+	if (!m_Mapped)
+		return;
+
+	GLCall(glBindBuffer(GL_PIXEL_UNPACK_BUFFER, m_PixelBuffers[m_NextBuffer]));
+	GLCall(glUnmapBuffer(GL_PIXEL_UNPACK_BUFFER));
+	m_Mapped = nullptr;
+
+	GLCall(glBindTexture(GL_TEXTURE_2D, m_Texture->GetRendererID()));
+	const unsigned int dataFormat = Texture::GetDataFormat(m_Channels);
+	for (const Region& region : m_Regions)
+	{
+		Texture::SetUnpackAlignment((size_t)region.Width * m_Channels);
+		GLCall(glTexSubImage2D(GL_TEXTURE_2D, 0, region.X, region.Y, region.Width, region.Height, dataFormat, GL_UNSIGNED_BYTE, (const void*)region.Offset));
+		RenderStats::Current().TextureBytesUploaded += (size_t)region.Width * region.Height * m_Channels;
+	}
+	GLCall(glPixelStorei(GL_UNPACK_ALIGNMENT, 4));
+	GLCall(glBindTexture(GL_TEXTURE_2D, 0));
+	GLCall(glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0));
+
+	GLCall(m_Fences[m_NextBuffer] = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0));
+	m_NextBuffer = (m_NextBuffer + 1) % (int)m_PixelBuffers.size();
+}
+
+bool DynamicTexture::Update(const unsigned char* pixels)
+{
+	if (!BeginUpdate())
+		return false;
+	const bool updated = UpdateRegion(0, 0, GetWidth(), GetHeight(), pixels);
+	EndUpdate();
+	return updated;
+}
@@ -0,0 +1,58 @@
+#pragma once
+
+#include <memory>
+#include <vector>
+
+#include "Texture.h"
+
+//A texture whose contents change every frame, for video and procedural images. Pixels are written into one of
+//a ring of pixel unpack buffers and glTexSubImage2D copies them from there on the GPU's own time. Each buffer
+//gets a fence when its uploads are issued and isn't written again until that fence has passed, so neither the
+//CPU nor the driver ever waits on the other.
+class DynamicTexture
+{
+private:
+	struct Region
+	{
+		int X, Y, Width, Height;
+		size_t Offset;
+	};
+
+	std::unique_ptr<Texture> m_Texture;
+	int m_Channels;
+	std::vector<unsigned int> m_PixelBuffers;
+	std::vector<GLsync> m_Fences; //Of the last uploads from each buffer, null once they have finished
+	size_t m_BufferSize;
+	int m_NextBuffer;
+
+	//Only valid between BeginUpdate and EndUpdate
+	unsigned char* m_Mapped;
+	size_t m_MappedUsed;
+	std::vector<Region> m_Regions;
+
+public:
+	//bufferCount is how many updates can be in flight at once, three covers the usual two frames of latency
+	DynamicTexture(int width, int height, int channels = 4, int bufferCount = 3);
+	~DynamicTexture();
+
+	DynamicTexture(const DynamicTexture&) = delete;
+	DynamicTexture& operator=(const DynamicTexture&) = delete;
+
+	//Maps the next buffer in the ring. Returns false without waiting if the GPU is still reading it, in which
+	//case the caller keeps showing the old contents and tries again next frame
+	bool BeginUpdate();
+	//Space for a region of tightly packed rows, written in order of increasing y. Regions from one update share
+	//the buffer, which holds one full texture's worth of pixels; returns null once that is used up
+	unsigned char* MapRegion(int x, int y, int width, int height);
+	bool UpdateRegion(int x, int y, int width, int height, const unsigned char* pixels);
+	//Issues the uploads for every region and fences the buffer
+	void EndUpdate();
+
+	//Replaces the whole texture in one go, false if no buffer was free
+	bool Update(const unsigned char* pixels);
+
+	inline void Bind(unsigned int slot = 0) const { m_Texture->Bind(slot); }
+	inline const Texture& GetTexture() const { return *m_Texture; }
+	inline int GetWidth() const { return m_Texture->GetWidth(); }
+	inline int GetHeight() const { return m_Texture->GetHeight(); }
+};
@@ -0,0 +1,244 @@
+//Generated by tools/EmbedShaders.py from res/shaders, don't edit this file by hand
+#pragma once
+
+#include <string_view>
+
+enum class EmbeddedShaderID
+{
+	Basic,
+	TextureArray,
+	Video,
+	VirtualTexture,
+	VirtualTextureFeedback,
+	Count
+};
+
+struct EmbeddedShader
+{
+	std::string_view FilePath; //Where the source lives on disk, used to hot reload it during development
+	std::string_view VertexSource;
+	std::string_view FragmentSource;
+	std::string_view ComputeSource;
+};
+
+inline constexpr EmbeddedShader s_EmbeddedShaders[] =
+{
+	{
+		"res/shaders/Basic.shader",
+		R"SHADER(#version 330 core
+		
+layout(location = 0) in vec4 position;
+layout(location = 1) in vec2 texCoord;
+
+out vec2 v_TexCoord;
+
+uniform mat4 u_MVP;
+		
+void main()
+{
+	gl_Position = u_MVP * position;
+	v_TexCoord = texCoord;
+};
+
+)SHADER",
+		R"SHADER(#version 330 core
+		
+layout(location = 0) out vec4 colour;
+
+in vec2 v_TexCoord;
+uniform vec4 u_Colour;
+uniform sampler2D u_Texture;
+
+		
+void main()
+{
+	vec4 texColour = texture(u_Texture, v_TexCoord);
+	colour = texColour;
+};
+)SHADER",
+		"",
+	},
+	{
+		"res/shaders/TextureArray.shader",
+		R"SHADER(#version 330 core
+		
+layout(location = 0) in vec4 position;
+layout(location = 1) in vec2 texCoord;
+layout(location = 2) in float layer; //Per vertex, or per instance from a buffer with a divisor of 1
+
+out vec2 v_TexCoord;
+flat out float v_Layer;
+
+uniform mat4 u_MVP;
+		
+void main()
+{
+	gl_Position = u_MVP * position;
+	v_TexCoord = texCoord;
+	v_Layer = layer;
+};
+
+)SHADER",
+		R"SHADER(#version 330 core
+		
+layout(location = 0) out vec4 colour;
+
+in vec2 v_TexCoord;
+flat in float v_Layer;
+uniform sampler2DArray u_Textures;
+
+		
+void main()
+{
+	colour = texture(u_Textures, vec3(v_TexCoord, v_Layer));
+};
+)SHADER",
+		"",
+	},
+	{
+		"res/shaders/Video.shader",
+		R"SHADER(#version 330 core
+		
+layout(location = 0) in vec4 position;
+layout(location = 1) in vec2 texCoord;
+
+out vec2 v_TexCoord;
+
+uniform mat4 u_MVP;
+		
+void main()
+{
+	gl_Position = u_MVP * position;
+	v_TexCoord = texCoord;
+};
+
+)SHADER",
+		R"SHADER(#version 330 core
+		
+layout(location = 0) out vec4 colour;
+
+in vec2 v_TexCoord;
+
+uniform sampler2D u_Planes; //Y on top, U and V side by side below it, see VideoPlayer
+uniform vec2 u_LumaSize;
+
+		
+void main()
+{
+	//Video rows are stored top first, and each plane is sampled no closer than half a texel to its edge so
+	//filtering never picks up its neighbour
+	vec2 size = vec2(textureSize(u_Planes, 0));
+	vec2 chromaSize = ceil(u_LumaSize * 0.5);
+	vec2 coord = vec2(v_TexCoord.x, 1.0 - v_TexCoord.y);
+	vec2 luma = clamp(coord * u_LumaSize, vec2(0.5), u_LumaSize - 0.5);
+	vec2 chroma = clamp(coord * chromaSize, vec2(0.5), chromaSize - 0.5);
+
+	float y = texture(u_Planes, luma / size).r;
+	float u = texture(u_Planes, (chroma + vec2(0.0, u_LumaSize.y)) / size).r - 0.5;
+	float v = texture(u_Planes, (chroma + vec2(chromaSize.x, u_LumaSize.y)) / size).r - 0.5;
+
+	//BT.601 with studio range luma, which is what raw captures nearly always are
+	y = 1.164 * (y - 16.0 / 255.0);
+	colour = vec4(y + 1.596 * v, y - 0.392 * u - 0.813 * v, y + 2.017 * u, 1.0);
+};
+)SHADER",
+		"",
+	},
+	{
+		"res/shaders/VirtualTexture.shader",
+		R"SHADER(#version 330 core
+		
+layout(location = 0) in vec4 position;
+layout(location = 1) in vec2 texCoord;
+
+out vec2 v_TexCoord;
+
+uniform mat4 u_MVP;
+		
+void main()
+{
+	gl_Position = u_MVP * position;
+	v_TexCoord = texCoord;
+};
+
+)SHADER",
+		R"SHADER(#version 330 core
+		
+layout(location = 0) out vec4 colour;
+
+in vec2 v_TexCoord;
+
+uniform sampler2D u_PageCache;
+uniform sampler2DArray u_Indirection; //One layer per level, each texel maps a level 0 page to a cached page
+uniform vec2 u_VirtualSize;
+uniform float u_PageSize;
+uniform float u_CacheSize;
+uniform int u_MaxLevel;
+
+		
+void main()
+{
+	vec2 pixel = v_TexCoord * u_VirtualSize;
+	vec2 dx = dFdx(pixel), dy = dFdy(pixel);
+	int level = clamp(int(floor(0.5 * log2(max(dot(dx, dx), dot(dy, dy))))), 0, u_MaxLevel);
+
+	//The entry holds the cache slot and the level of the page that is actually resident, which can be coarser
+	ivec2 page = clamp(ivec2(pixel / u_PageSize), ivec2(0), textureSize(u_Indirection, 0).xy - 1);
+	vec3 entry = texelFetch(u_Indirection, ivec3(page, level), 0).xyz * 255.0;
+
+	vec2 local = fract(pixel / (u_PageSize * exp2(entry.z)));
+	vec2 uv = (entry.xy * (u_PageSize + 2.0) + 1.0 + local * u_PageSize) / u_CacheSize;
+	colour = texture(u_PageCache, uv);
+};
+)SHADER",
+		"",
+	},
+	{
+		"res/shaders/VirtualTextureFeedback.shader",
+		R"SHADER(#version 330 core
+		
+layout(location = 0) in vec4 position;
+layout(location = 1) in vec2 texCoord;
+
+out vec2 v_TexCoord;
+
+uniform mat4 u_MVP;
+		
+void main()
+{
+	gl_Position = u_MVP * position;
+	v_TexCoord = texCoord;
+};
+
+)SHADER",
+		R"SHADER(#version 330 core
+		
+layout(location = 0) out vec4 colour;
+
+in vec2 v_TexCoord;
+
+uniform vec2 u_VirtualSize;
+uniform float u_PageSize;
+uniform int u_MaxLevel;
+uniform float u_LevelBias; //Makes up for rendering the feedback at a lower resolution than the screen
+
+		
+void main()
+{
+	vec2 pixel = v_TexCoord * u_VirtualSize;
+	vec2 dx = dFdx(pixel), dy = dFdy(pixel);
+	int level = clamp(int(floor(0.5 * log2(max(dot(dx, dx), dot(dy, dy))) + u_LevelBias)), 0, u_MaxLevel);
+
+	//Page x and y get 12 bits each, the low 8 in red and green and the high 4 packed into blue. Alpha is level + 1
+	ivec2 page = max(ivec2(pixel / (u_PageSize * exp2(float(level)))), ivec2(0));
+	colour = vec4(float(page.x & 255), float(page.y & 255), float(((page.x >> 8) & 15) | (((page.y >> 8) & 15) << 4)), float(level + 1)) / 255.0;
+};
+)SHADER",
+		"",
+	},
+};
+
+inline constexpr const EmbeddedShader& GetEmbeddedShader(EmbeddedShaderID id)
+{
+	return s_EmbeddedShaders[(int)id];
+}
@@ -0,0 +1,127 @@
+#include "Framebuffer.h"
+#include "Log.h"
+
+Framebuffer::Framebuffer(int width, int height, bool depth, unsigned int colourFormat)
+	: m_RendererID(0), m_DepthBuffer(0), m_Width(width), m_Height(height), m_ColourFormat(colourFormat), m_HasDepth(depth),
+	  m_PreviousViewport{ 0, 0, width, height }
+{
+	Create();
+}
+
+Framebuffer::~Framebuffer()
+{
+	Destroy();
+}
+
+void Framebuffer::Create()
+{
+	GLCall(glGenFramebuffers(1, &m_RendererID));
+	GLCall(glBindFramebuffer(GL_FRAMEBUFFER, m_RendererID));
+
+	if (m_ColourFormat != 0)
+	{
+		m_ColourAttachment = std::make_unique<Texture>(m_Width, m_Height, m_ColourFormat);
+		GLCall(glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, m_ColourAttachment->GetRendererID(), 0));
+	}
+	else
+	{
+		GLCall(glDrawBuffer(GL_NONE));
+		GLCall(glReadBuffer(GL_NONE));
+	}
+
+	if (m_HasDepth)
+	{
+		GLCall(glGenRenderbuffers(1, &m_DepthBuffer));
+		GLCall(glBindRenderbuffer(GL_RENDERBUFFER, m_DepthBuffer));
+		GLCall(glRenderbufferStorage(GL_RENDERBUFFER, GL_DEPTH24_STENCIL8, m_Width, m_Height));
+		GLCall(glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_DEPTH_STENCIL_ATTACHMENT, GL_RENDERBUFFER, m_DepthBuffer));
+		GLCall(glBindRenderbuffer(GL_RENDERBUFFER, 0));
+	}
+
+	GLCall(unsigned int status = glCheckFramebufferStatus(GL_FRAMEBUFFER));
+	if (status != GL_FRAMEBUFFER_COMPLETE)
+		Log::Error("Framebuffer {}x{} is incomplete ({})!", m_Width, m_Height, status);
+
+	GLCall(glBindFramebuffer(GL_FRAMEBUFFER, 0));
+}
+
+void Framebuffer::Destroy()
+{
+	GLCall(glDeleteFramebuffers(1, &m_RendererID));
+	if (m_DepthBuffer)
+	{
+		GLCall(glDeleteRenderbuffers(1, &m_DepthBuffer));
+	}
+	m_RendererID = m_DepthBuffer = 0;
+	m_ColourAttachment.reset();
+}
+
+void Framebuffer::Bind() const
+{
+	GLCall(glGetIntegerv(GL_VIEWPORT, m_PreviousViewport));
+	GLCall(glBindFramebuffer(GL_FRAMEBUFFER, m_RendererID));
+	GLCall(glViewport(0, 0, m_Width, m_Height));
+}
+
+void Framebuffer::UnBind() const
+{
+	GLCall(glBindFramebuffer(GL_FRAMEBUFFER, 0));
+	GLCall(glViewport(m_PreviousViewport[0], m_PreviousViewport[1], m_PreviousViewport[2], m_PreviousViewport[3]));
+}
+
+void Framebuffer::Resize(int width, int height)
+{
+	if (width == m_Width && height == m_Height)
+		return;
+
+	Destroy();
+	m_Width = width;
+	m_Height = height;
+	Create();
+}
+
+void Framebuffer::Blit(const Framebuffer& destination, unsigned int mask, unsigned int filter) const
+{
+	BlitTo(destination.m_RendererID, destination.m_Width, destination.m_Height, mask, filter);
+}
+
+void Framebuffer::BlitToScreen(int width, int height, unsigned int filter) const
+{
+	BlitTo(0, width, height, GL_COLOR_BUFFER_BIT, filter);
+}
+
+//Whatever framebuffers were bound before are bound again afterwards, so this can be used in the middle of a pass
+void Framebuffer::BlitTo(unsigned int destinationID, int width, int height, unsigned int mask, unsigned int filter) const
+{
+	int previousRead, previousDraw;
+	GLCall(glGetIntegerv(GL_READ_FRAMEBUFFER_BINDING, &previousRead));
+	GLCall(glGetIntegerv(GL_DRAW_FRAMEBUFFER_BINDING, &previousDraw));
+
+	GLCall(glBindFramebuffer(GL_READ_FRAMEBUFFER, m_RendererID));
+	GLCall(glBindFramebuffer(GL_DRAW_FRAMEBUFFER, destinationID));
+	GLCall(glBlitFramebuffer(0, 0, m_Width, m_Height, 0, 0, width, height, mask, filter));
+
+	GLCall(glBindFramebuffer(GL_READ_FRAMEBUFFER, previousRead));
+	GLCall(glBindFramebuffer(GL_DRAW_FRAMEBUFFER, previousDraw));
+}
+
+void Framebuffer::ReadPixels(std::vector<unsigned char>& pixels) const
+{
+	pixels.resize((size_t)m_Width * m_Height * 4);
+	if (!m_ColourAttachment)
+		return;
+
+	int previousRead;
+	GLCall(glGetIntegerv(GL_READ_FRAMEBUFFER_BINDING, &previousRead));
+	GLCall(glBindFramebuffer(GL_READ_FRAMEBUFFER, m_RendererID));
+	GLCall(glReadPixels(0, 0, m_Width, m_Height, GL_RGBA, GL_UNSIGNED_BYTE, pixels.data()));
+	GLCall(glBindFramebuffer(GL_READ_FRAMEBUFFER, previousRead));
+}
+
+size_t Framebuffer::GetMemoryUsage() const
+{
+	size_t size = m_ColourAttachment ? m_ColourAttachment->GetMemoryUsage() : 0;
+	if (m_HasDepth)
+		size += (size_t)m_Width * m_Height * 4;
+	return size;
+}
@@ -0,0 +1,59 @@
+#pragma once
+
+#include <memory>
+#include <vector>
+
+#include "Texture.h"
+
+//Renders into a texture instead of the window. Bind switches the viewport to the framebuffer's size and
+//UnBind puts back whatever viewport was set before.
+class Framebuffer
+{
+private:
+	unsigned int m_RendererID;
+	unsigned int m_DepthBuffer;
+	int m_Width, m_Height;
+	unsigned int m_ColourFormat;
+	bool m_HasDepth;
+	std::unique_ptr<Texture> m_ColourAttachment;
+	mutable int m_PreviousViewport[4];
+
+public:
+	//A colour attachment of any uncompressed sized format, plus a depth and stencil buffer if depth is true.
+	//A colour format of 0 leaves the colour attachment out for depth only passes
+	Framebuffer(int width, int height, bool depth = false, unsigned int colourFormat = GL_RGBA8);
+	~Framebuffer();
+
+	Framebuffer(const Framebuffer&) = delete;
+	Framebuffer& operator=(const Framebuffer&) = delete;
+
+	void Bind() const;
+	void UnBind() const;
+
+	//Reallocates the attachments at the new size, their contents are lost
+	void Resize(int width, int height);
+
+	//Copies into another framebuffer, stretching if the sizes differ. Linear filtering only works on colour
+	void Blit(const Framebuffer& destination, unsigned int mask = GL_COLOR_BUFFER_BIT, unsigned int filter = GL_NEAREST) const;
+	//Copies the colour attachment into the window's back buffer, which is width by height
+	void BlitToScreen(int width, int height, unsigned int filter = GL_LINEAR) const;
+
+	//Reads the colour attachment back as RGBA8, bottom row first. This waits for the GPU to finish drawing
+	//into it, so it is for tools and tests rather than every frame
+	void ReadPixels(std::vector<unsigned char>& pixels) const;
+
+	inline bool HasColourAttachment() const { return m_ColourAttachment != nullptr; }
+	inline const Texture& GetColourAttachment() const { return *m_ColourAttachment; }
+	inline unsigned int GetColourFormat() const { return m_ColourFormat; }
+	inline bool HasDepth() const { return m_HasDepth; }
+	inline int GetWidth() const { return m_Width; }
+	inline int GetHeight() const { return m_Height; }
+	inline unsigned int GetRendererID() const { return m_RendererID; }
+	//Roughly what the attachments take up in video memory
+	size_t GetMemoryUsage() const;
+
+private:
+	void Create();
+	void Destroy();
+	void BlitTo(unsigned int destinationID, int width, int height, unsigned int mask, unsigned int filter) const;
+};
@@ -0,0 +1,270 @@
+#include "GLDebugOutput.h"
+#include "Renderer.h"
+#include "Log.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+
+bool GLDebugOutput::s_Active = false;
+bool GLDebugOutput::s_ReportsErrors = false;
+
+namespace
+{
+	const char* GetSourceName(unsigned int source)
+	{
+		switch (source)
+		{
+			case GL_DEBUG_SOURCE_API: return "API";
+			case GL_DEBUG_SOURCE_WINDOW_SYSTEM: return "Window System";
+			case GL_DEBUG_SOURCE_SHADER_COMPILER: return "Shader Compiler";
+			case GL_DEBUG_SOURCE_THIRD_PARTY: return "Third Party";
+			case GL_DEBUG_SOURCE_APPLICATION: return "Application";
+			default: return "Other";
+		}
+	}
+
+	const char* GetTypeName(unsigned int type)
+	{
+		switch (type)
+		{
+			case GL_DEBUG_TYPE_ERROR: return "Error";
+			case GL_DEBUG_TYPE_DEPRECATED_BEHAVIOR: return "Deprecated";
+			case GL_DEBUG_TYPE_UNDEFINED_BEHAVIOR: return "Undefined Behaviour";
+			case GL_DEBUG_TYPE_PORTABILITY: return "Portability";
+			case GL_DEBUG_TYPE_PERFORMANCE: return "Performance";
+			case GL_DEBUG_TYPE_MARKER: return "Marker";
+			default: return "Other";
+		}
+	}
+}
+
+GLDebugOutput::GLDebugOutput(unsigned int minimumSeverity)
+	: m_EnqueuePosition(0), m_DequeuePosition(0), m_Overflowed(0), m_MinimumRank(GetSeverityRank(minimumSeverity)),
+	  m_BreakOnError(GL_CHECK_POLICY == GL_CHECK_FULL), m_PrintedThisSecond(0), m_Suppressed(0), m_Running(false)
+{
+	for (size_t i = 0; i < QueueSize; i++)
+		m_Queue[i].Sequence.store(i, std::memory_order_relaxed);
+	for (SeenMessage& seen : m_Seen)
+	{
+		seen.Key.store(0, std::memory_order_relaxed);
+		seen.Repeats.store(0, std::memory_order_relaxed);
+	}
+
+	if (!GLEW_VERSION_4_3 && !GLEW_KHR_debug)
+	{
+		Log::Warning("KHR_debug isn't supported, GL errors are only caught by GLCall");
+		return;
+	}
+
+	GLCall(glEnable(GL_DEBUG_OUTPUT));
+	//Debug builds break on the call that caused an error like GLCall used to, which needs the callback on its thread
+	if (m_BreakOnError)
+	{
+		GLCall(glEnable(GL_DEBUG_OUTPUT_SYNCHRONOUS));
+	}
+
+	const unsigned int severities[] = { GL_DEBUG_SEVERITY_NOTIFICATION, GL_DEBUG_SEVERITY_LOW, GL_DEBUG_SEVERITY_MEDIUM, GL_DEBUG_SEVERITY_HIGH };
+	for (unsigned int severity : severities)
+	{
+		GLCall(glDebugMessageControl(GL_DONT_CARE, GL_DONT_CARE, severity, 0, nullptr, GetSeverityRank(severity) >= m_MinimumRank ? GL_TRUE : GL_FALSE));
+	}
+	GLCall(glDebugMessageCallback(Callback, this));
+
+	m_Running = true;
+	m_Writer = std::thread(&GLDebugOutput::WriterLoop, this);
+	s_Active = true;
+
+	int flags = 0;
+	GLCall(glGetIntegerv(GL_CONTEXT_FLAGS, &flags));
+	s_ReportsErrors = (flags & GL_CONTEXT_FLAG_DEBUG_BIT) != 0;
+	if (!s_ReportsErrors)
+		Log::Info("Not a debug context, GL errors are still checked by GLCall");
+}
+
+GLDebugOutput::~GLDebugOutput()
+{
+	if (!m_Running)
+		return;
+
+	s_Active = false;
+	s_ReportsErrors = false;
+	GLCall(glDebugMessageCallback(nullptr, nullptr));
+	GLCall(glDisable(GL_DEBUG_OUTPUT));
+
+	{
+		std::lock_guard<std::mutex> lock(m_Mutex);
+		m_Running = false;
+	}
+	m_Condition.notify_one();
+	m_Writer.join();
+}
+
+void GLDebugOutput::SetLabel(unsigned int identifier, unsigned int name, const std::string& label)
+{
+	if (!s_Active || label.empty())
+		return;
+
+	//GL_MAX_LABEL_LENGTH is at least 256, the end of a path is the part worth keeping
+	const size_t maxLength = 255;
+	const std::string& trimmed = label.size() > maxLength ? label.substr(label.size() - maxLength) : label;
+	GLCall(glObjectLabel(identifier, name, (int)trimmed.size(), trimmed.c_str()));
+}
+
+int GLDebugOutput::GetSeverityRank(unsigned int severity)
+{
+	switch (severity)
+	{
+		case GL_DEBUG_SEVERITY_HIGH: return 3;
+		case GL_DEBUG_SEVERITY_MEDIUM: return 2;
+		case GL_DEBUG_SEVERITY_LOW: return 1;
+		default: return 0;
+	}
+}
+
+void GLAPIENTRY GLDebugOutput::Callback(GLenum source, GLenum type, GLuint id, GLenum severity, GLsizei length, const GLchar* message, const void* userParam)
+{
+	GLDebugOutput* output = (GLDebugOutput*)userParam;
+	if (GetSeverityRank(severity) < output->m_MinimumRank)
+		return;
+
+	if (output->m_BreakOnError && type == GL_DEBUG_TYPE_ERROR)
+	{
+		//Written out straight away since the break may be the end of the program
+		Log::Error("[OpenGL Error] ({}) {}", id, message);
+		Log::Flush();
+		DEBUG_BREAK();
+	}
+	if (!output->IsRepeat(source, type, id))
+		output->Push(source, type, id, severity, length, message);
+}
+
+//Open addressing over a fixed table, entries are claimed with a compare exchange and never removed. If the
+//table is too full to find a place the message is queued again, which only costs some duplicate lines
+bool GLDebugOutput::IsRepeat(unsigned int source, unsigned int type, unsigned int id)
+{
+	const unsigned long long key = ((unsigned long long)source << 48) | ((unsigned long long)(type & 0xFFFF) << 32) | id;
+	const size_t maxProbes = 16;
+	for (size_t i = 0; i < maxProbes; i++)
+	{
+		SeenMessage& seen = m_Seen[(id + i) & (SeenSize - 1)];
+		unsigned long long current = seen.Key.load(std::memory_order_relaxed);
+		if (current == 0 && seen.Key.compare_exchange_strong(current, key, std::memory_order_relaxed))
+			return false;
+		if (current == key)
+		{
+			seen.Repeats.fetch_add(1, std::memory_order_relaxed);
+			return true;
+		}
+	}
+	return false;
+}
+
+void GLDebugOutput::Push(unsigned int source, unsigned int type, unsigned int id, unsigned int severity, int length, const char* text)
+{
+	//Claims a cell by moving the enqueue position past it, a cell is free once the reader has set its sequence
+	//to the position that will next use it
+	Cell* cell;
+	size_t position = m_EnqueuePosition.load(std::memory_order_relaxed);
+	while (true)
+	{
+		cell = &m_Queue[position & (QueueSize - 1)];
+		const size_t sequence = cell->Sequence.load(std::memory_order_acquire);
+		const ptrdiff_t difference = (ptrdiff_t)sequence - (ptrdiff_t)position;
+		if (difference == 0)
+		{
+			if (m_EnqueuePosition.compare_exchange_weak(position, position + 1, std::memory_order_relaxed))
+				break;
+		}
+		else if (difference < 0)
+		{
+			m_Overflowed.fetch_add(1, std::memory_order_relaxed);
+			return;
+		}
+		else
+			position = m_EnqueuePosition.load(std::memory_order_relaxed);
+	}
+
+	Message& message = cell->Data;
+	message.Source = source;
+	message.Type = type;
+	message.ID = id;
+	message.Severity = severity;
+	const size_t textLength = std::min(length < 0 ? strlen(text) : (size_t)length, sizeof(message.Text) - 1);
+	memcpy(message.Text, text, textLength);
+	message.Text[textLength] = 0;
+	cell->Sequence.store(position + 1, std::memory_order_release);
+}
+
+bool GLDebugOutput::Pop(Message& message)
+{
+	Cell& cell = m_Queue[m_DequeuePosition & (QueueSize - 1)];
+	if (cell.Sequence.load(std::memory_order_acquire) != m_DequeuePosition + 1)
+		return false;
+
+	message = cell.Data;
+	cell.Sequence.store(m_DequeuePosition + QueueSize, std::memory_order_release);
+	m_DequeuePosition++;
+	return true;
+}
+
+void GLDebugOutput::WriterLoop()
+{
+	using Clock = std::chrono::steady_clock;
+	Clock::time_point secondStart = Clock::now(), lastReport = secondStart;
+
+	bool running = true;
+	while (running)
+	{
+		{
+			std::unique_lock<std::mutex> lock(m_Mutex);
+			m_Condition.wait_for(lock, std::chrono::milliseconds(10), [this] { return !m_Running; });
+			running = m_Running;
+		}
+
+		Message message;
+		while (Pop(message))
+			Print(message);
+
+		const Clock::time_point now = Clock::now();
+		if (now - lastReport >= std::chrono::seconds(5) || !running)
+		{
+			Report();
+			lastReport = now;
+		}
+		if (now - secondStart >= std::chrono::seconds(1) || !running)
+		{
+			if (m_Suppressed)
+				Log::Warning("[OpenGL] {} messages suppressed, more than {} a second", m_Suppressed, MessagesPerSecond);
+			m_Suppressed = 0;
+			m_PrintedThisSecond = 0;
+			secondStart = now;
+		}
+	}
+}
+
+void GLDebugOutput::Print(const Message& message)
+{
+	if (m_PrintedThisSecond == MessagesPerSecond)
+	{
+		m_Suppressed++;
+		return;
+	}
+	m_PrintedThisSecond++;
+
+	Log::Write(message.Type == GL_DEBUG_TYPE_ERROR ? LogLevel::Error : LogLevel::Warning, "[OpenGL {}] ({}) {}: {}", GetTypeName(message.Type), message.ID, GetSourceName(message.Source), message.Text);
+}
+
+void GLDebugOutput::Report()
+{
+	for (SeenMessage& seen : m_Seen)
+	{
+		const unsigned int repeats = seen.Repeats.exchange(0, std::memory_order_relaxed);
+		if (repeats)
+			Log::Warning("[OpenGL] Message {} repeated {} times", (unsigned int)(seen.Key.load(std::memory_order_relaxed) & 0xFFFFFFFF), repeats);
+	}
+
+	const unsigned int overflowed = m_Overflowed.exchange(0, std::memory_order_relaxed);
+	if (overflowed)
+		Log::Warning("[OpenGL] {} messages lost, the queue was full", overflowed);
+}
@@ -0,0 +1,89 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <mutex>
+#include <string>
+#include <thread>
+
+#include <glew.h>
+
+//Has the driver report errors and warnings through a KHR_debug callback instead of GLCall polling glGetError.
+//The callback only copies the message into a lock free queue and a writer thread prints them. Repeats of a
+//message are counted in the callback rather than queued, so an error every draw can't crowd out other
+//messages, and at most MessagesPerSecond are printed. While this is active GLClearError and GLLogCall do nothing.
+//Objects labelled with SetLabel show up by name in the driver's messages where the driver supports it.
+class GLDebugOutput
+{
+private:
+	struct Message
+	{
+		unsigned int Source, Type, ID, Severity;
+		char Text[496];
+	};
+
+	struct Cell
+	{
+		std::atomic<size_t> Sequence;
+		Message Data;
+	};
+
+	struct SeenMessage
+	{
+		std::atomic<unsigned long long> Key; //Source, type and ID, 0 while the entry is free
+		std::atomic<unsigned int> Repeats; //Since the writer last reported them
+	};
+
+	static const size_t QueueSize = 256; //Power of two
+	static const size_t SeenSize = 1024; //Power of two
+	static const unsigned int MessagesPerSecond = 20;
+
+	static bool s_Active;
+	static bool s_ReportsErrors;
+
+	//Bounded multi producer queue, the driver may call back from its own threads
+	Cell m_Queue[QueueSize];
+	std::atomic<size_t> m_EnqueuePosition;
+	size_t m_DequeuePosition;
+	std::atomic<unsigned int> m_Overflowed;
+	SeenMessage m_Seen[SeenSize];
+
+	int m_MinimumRank;
+	bool m_BreakOnError;
+
+	//Only touched by the writer thread
+	unsigned int m_PrintedThisSecond, m_Suppressed;
+
+	std::thread m_Writer;
+	std::mutex m_Mutex;
+	std::condition_variable m_Condition;
+	bool m_Running;
+
+public:
+	//minimumSeverity is the least severe GL_DEBUG_SEVERITY_* that gets reported, anything below it is disabled in
+	//the driver so it isn't even generated. Does nothing without GL 4.3 or KHR_debug
+	GLDebugOutput(unsigned int minimumSeverity = GL_DEBUG_SEVERITY_LOW);
+	~GLDebugOutput();
+
+	GLDebugOutput(const GLDebugOutput&) = delete;
+	GLDebugOutput& operator=(const GLDebugOutput&) = delete;
+
+	static inline bool IsActive() { return s_Active; }
+	//Only a debug context has to report every error, in any other the driver may stay quiet so GLCall still checks
+	static inline bool IsReportingErrors() { return s_ReportsErrors; }
+
+	//Names a GL object in debug messages and debuggers, identifier is GL_TEXTURE, GL_PROGRAM, GL_BUFFER and so on
+	static void SetLabel(unsigned int identifier, unsigned int name, const std::string& label);
+
+private:
+	static void GLAPIENTRY Callback(GLenum source, GLenum type, GLuint id, GLenum severity, GLsizei length, const GLchar* message, const void* userParam);
+	bool IsRepeat(unsigned int source, unsigned int type, unsigned int id);
+	void Push(unsigned int source, unsigned int type, unsigned int id, unsigned int severity, int length, const char* message);
+	bool Pop(Message& message);
+	void WriterLoop();
+	void Print(const Message& message);
+	void Report();
+
+	static int GetSeverityRank(unsigned int severity);
+};
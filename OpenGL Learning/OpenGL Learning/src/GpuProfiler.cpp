@@ -0,0 +1,187 @@
+#include "GpuProfiler.h"
+#include "Renderer.h"
+
+#include <algorithm>
+#include <cstdint>
+
+GpuProfiler::GpuProfiler()
+	: m_CurrentSlot(0), m_DroppedFrames(0), m_InFrame(false)
+{
+	for (Slot& slot : m_Slots)
+	{
+		slot.QueriesUsed = 0;
+		slot.Pending = false;
+	}
+}
+
+GpuProfiler::~GpuProfiler()
+{
+	for (Slot& slot : m_Slots)
+	{
+		if (!slot.Queries.empty())
+		{
+			GLCall(glDeleteQueries((int)slot.Queries.size(), slot.Queries.data()));
+		}
+	}
+}
+
+void GpuProfiler::BeginFrame()
+{
+	//Older slots are read first so passes keep their history in order
+	for (int i = 1; i <= FrameCount; i++)
+	{
+		Slot& slot = m_Slots[(m_CurrentSlot + i) % FrameCount];
+		if (slot.Pending)
+			Collect(slot);
+	}
+
+	m_CurrentSlot = (m_CurrentSlot + 1) % FrameCount;
+	Slot& slot = m_Slots[m_CurrentSlot];
+	if (slot.Pending)
+	{
+		//Still not finished after FrameCount frames, reading it now would stall so it is given up on
+		m_DroppedFrames++;
+		slot.Pending = false;
+	}
+	slot.QueriesUsed = 0;
+	slot.Timings.clear();
+	m_Open.clear();
+
+	m_InFrame = true;
+	BeginPass("Frame");
+}
+
+void GpuProfiler::EndFrame()
+{
+	if (!m_InFrame)
+		return;
+
+	//Anything left open is closed along with the frame
+	while (m_Open.size() > 1)
+		EndPass();
+	EndPass();
+
+	m_Slots[m_CurrentSlot].Pending = !m_Slots[m_CurrentSlot].Timings.empty();
+	m_InFrame = false;
+}
+
+void GpuProfiler::BeginPass(const std::string& name)
+{
+	if (!m_InFrame)
+		return;
+
+	Timing timing;
+	timing.Pass = FindPass(name);
+	timing.Start = AddTimestamp(m_Slots[m_CurrentSlot]);
+	timing.End = 0;
+	m_Open.push_back(timing);
+}
+
+void GpuProfiler::EndPass()
+{
+	if (!m_InFrame || m_Open.empty())
+		return;
+
+	Slot& slot = m_Slots[m_CurrentSlot];
+	Timing timing = m_Open.back();
+	m_Open.pop_back();
+	timing.End = AddTimestamp(slot);
+	slot.Timings.push_back(timing);
+}
+
+int GpuProfiler::FindPass(const std::string& name)
+{
+	for (unsigned int i = 0; i < m_Passes.size(); i++)
+	{
+		if (m_Passes[i].Name == name)
+			return (int)i;
+	}
+
+	Pass pass;
+	pass.Name = name;
+	pass.HistoryCount = 0;
+	pass.HistoryNext = 0;
+	m_Passes.push_back(pass);
+	return (int)m_Passes.size() - 1;
+}
+
+unsigned int GpuProfiler::AddTimestamp(Slot& slot)
+{
+	//Query objects are kept between frames, a slot only ever grows to the most any frame has needed
+	if (slot.QueriesUsed == slot.Queries.size())
+	{
+		unsigned int query;
+		GLCall(glGenQueries(1, &query));
+		slot.Queries.push_back(query);
+	}
+
+	const unsigned int index = slot.QueriesUsed++;
+	GLCall(glQueryCounter(slot.Queries[index], GL_TIMESTAMP));
+	return index;
+}
+
+void GpuProfiler::Collect(Slot& slot)
+{
+	//Timestamps finish in the order they were issued, so once the last one is back they all are
+	int available = 0;
+	GLCall(glGetQueryObjectiv(slot.Queries[slot.QueriesUsed - 1], GL_QUERY_RESULT_AVAILABLE, &available));
+	if (!available)
+		return;
+
+	std::vector<uint64_t> times(slot.QueriesUsed);
+	for (unsigned int i = 0; i < slot.QueriesUsed; i++)
+	{
+		GLCall(glGetQueryObjectui64v(slot.Queries[i], GL_QUERY_RESULT, &times[i]));
+	}
+
+	//A pass run several times in a frame is reported as its total
+	std::vector<float> totals(m_Passes.size(), -1.0f);
+	for (const Timing& timing : slot.Timings)
+	{
+		const float ms = (float)((double)(times[timing.End] - times[timing.Start]) / 1000000.0);
+		totals[timing.Pass] = std::max(totals[timing.Pass], 0.0f) + ms;
+	}
+	for (unsigned int i = 0; i < m_Passes.size(); i++)
+	{
+		if (totals[i] < 0.0f)
+			continue;
+		Pass& pass = m_Passes[i];
+		pass.History[pass.HistoryNext] = totals[i];
+		pass.HistoryNext = (pass.HistoryNext + 1) % HistorySize;
+		pass.HistoryCount = std::min(pass.HistoryCount + 1, HistorySize);
+	}
+
+	slot.Pending = false;
+}
+
+GpuProfiler::PassStats GpuProfiler::MakeStats(const Pass& pass) const
+{
+	PassStats stats = { pass.Name, 0.0f, 0.0f, 0.0f, 0.0f };
+	if (pass.HistoryCount == 0)
+		return stats;
+
+	stats.LastMs = pass.History[(pass.HistoryNext + HistorySize - 1) % HistorySize];
+	stats.MinMs = stats.MaxMs = stats.LastMs;
+	float total = 0.0f;
+	for (int i = 0; i < pass.HistoryCount; i++)
+	{
+		stats.MinMs = std::min(stats.MinMs, pass.History[i]);
+		stats.MaxMs = std::max(stats.MaxMs, pass.History[i]);
+		total += pass.History[i];
+	}
+	stats.AverageMs = total / pass.HistoryCount;
+	return stats;
+}
+
+std::vector<GpuProfiler::PassStats> GpuProfiler::GetStats() const
+{
+	std::vector<PassStats> stats;
+	for (const Pass& pass : m_Passes)
+		stats.push_back(MakeStats(pass));
+	return stats;
+}
+
+float GpuProfiler::GetFrameMs() const
+{
+	return m_Passes.empty() ? 0.0f : MakeStats(m_Passes[0]).AverageMs;
+}
@@ -0,0 +1,92 @@
+#pragma once
+
+#include <string>
+#include <vector>
+
+//Times named render passes on the GPU with GL_TIMESTAMP queries. Results come back several frames later, so
+//each frame writes its queries into the next slot of a ring and BeginFrame only reads slots whose results are
+//already available, nothing ever waits on the GPU. Passes can nest since each one is a pair of timestamps.
+//Each pass keeps its last HistorySize times for min, average and max.
+class GpuProfiler
+{
+public:
+	struct PassStats
+	{
+		std::string Name;
+		float LastMs, MinMs, AverageMs, MaxMs;
+	};
+
+private:
+	static const int FrameCount = 4; //Frames that can be in flight before a slot is reused
+	static const int HistorySize = 120;
+
+	struct Pass
+	{
+		std::string Name;
+		float History[HistorySize];
+		int HistoryCount, HistoryNext;
+	};
+
+	struct Timing
+	{
+		int Pass;
+		unsigned int Start, End; //Indices into the slot's queries
+	};
+
+	struct Slot
+	{
+		std::vector<unsigned int> Queries;
+		unsigned int QueriesUsed;
+		std::vector<Timing> Timings;
+		bool Pending; //Has queries whose results haven't been read yet
+	};
+
+	Slot m_Slots[FrameCount];
+	int m_CurrentSlot;
+	std::vector<Pass> m_Passes;
+	std::vector<Timing> m_Open; //Passes begun but not yet ended this frame
+	unsigned int m_DroppedFrames;
+	bool m_InFrame;
+
+public:
+	GpuProfiler();
+	~GpuProfiler();
+
+	GpuProfiler(const GpuProfiler&) = delete;
+	GpuProfiler& operator=(const GpuProfiler&) = delete;
+
+	//Collects whatever earlier frames have finished and starts timing the whole frame as the "Frame" pass
+	void BeginFrame();
+	void EndFrame();
+
+	void BeginPass(const std::string& name);
+	void EndPass();
+
+	//One entry per pass name seen so far, the first being the whole frame
+	std::vector<PassStats> GetStats() const;
+	//Average GPU time of whole frames, compare with the CPU frame time to see which side is the bottleneck
+	float GetFrameMs() const;
+	//Frames whose results were still not back when their slot came round again and had to be thrown away
+	inline unsigned int GetDroppedFrames() const { return m_DroppedFrames; }
+
+private:
+	int FindPass(const std::string& name);
+	unsigned int AddTimestamp(Slot& slot);
+	void Collect(Slot& slot);
+	PassStats MakeStats(const Pass& pass) const;
+};
+
+//Times the enclosing scope as a pass: GpuTimerScope timer(profiler, "Scene");
+class GpuTimerScope
+{
+private:
+	GpuProfiler& m_Profiler;
+
+public:
+	GpuTimerScope(GpuProfiler& profiler, const std::string& name)
+		: m_Profiler(profiler) { m_Profiler.BeginPass(name); }
+	~GpuTimerScope() { m_Profiler.EndPass(); }
+
+	GpuTimerScope(const GpuTimerScope&) = delete;
+	GpuTimerScope& operator=(const GpuTimerScope&) = delete;
+};
@@ -0,0 +1,158 @@
+#include "HeadlessContext.h"
+#include "Renderer.h"
+#include "Log.h"
+
+#ifdef HEADLESS_EGL
+
+#include <EGL/egl.h>
+#include <EGL/eglext.h>
+#include <cstring>
+
+namespace {
+
+bool HasExtension(const char* extensions, const char* name)
+{
+	const size_t length = strlen(name);
+	for (const char* found = extensions ? strstr(extensions, name) : nullptr; found; found = strstr(found + length, name))
+	{
+		if ((found == extensions || found[-1] == ' ') && (found[length] == ' ' || found[length] == '\0'))
+			return true;
+	}
+	return false;
+}
+
+}
+
+HeadlessContext::HeadlessContext()
+	: m_Display(EGL_NO_DISPLAY), m_Context(EGL_NO_CONTEXT), m_Surface(EGL_NO_SURFACE), m_Valid(false)
+{
+}
+
+HeadlessContext::~HeadlessContext()
+{
+	if (m_Display == EGL_NO_DISPLAY)
+		return;
+
+	eglMakeCurrent(m_Display, EGL_NO_SURFACE, EGL_NO_SURFACE, EGL_NO_CONTEXT);
+	if (m_Surface != EGL_NO_SURFACE)
+		eglDestroySurface(m_Display, m_Surface);
+	if (m_Context != EGL_NO_CONTEXT)
+		eglDestroyContext(m_Display, m_Context);
+	eglTerminate(m_Display);
+}
+
+bool HeadlessContext::Create(int majorVersion, int minorVersion)
+{
+	//The surfaceless platform needs no X server, GPU or DRM device, the default display is the fallback
+	const char* clientExtensions = eglQueryString(EGL_NO_DISPLAY, EGL_EXTENSIONS);
+	auto getPlatformDisplay = (PFNEGLGETPLATFORMDISPLAYEXTPROC)eglGetProcAddress("eglGetPlatformDisplayEXT");
+	if (getPlatformDisplay && HasExtension(clientExtensions, "EGL_MESA_platform_surfaceless"))
+		m_Display = getPlatformDisplay(EGL_PLATFORM_SURFACELESS_MESA, EGL_DEFAULT_DISPLAY, nullptr);
+	if (m_Display == EGL_NO_DISPLAY)
+		m_Display = eglGetDisplay(EGL_DEFAULT_DISPLAY);
+
+	EGLint major, minor;
+	if (m_Display == EGL_NO_DISPLAY || !eglInitialize(m_Display, &major, &minor))
+	{
+		Log::Error("No EGL display is available ({})!", eglGetError());
+		m_Display = EGL_NO_DISPLAY;
+		return false;
+	}
+	if (!eglBindAPI(EGL_OPENGL_API))
+	{
+		Log::Error("EGL {}.{} can't create desktop OpenGL contexts!", major, minor);
+		return false;
+	}
+
+	const EGLint configAttributes[] = {
+		EGL_SURFACE_TYPE, EGL_PBUFFER_BIT,
+		EGL_RENDERABLE_TYPE, EGL_OPENGL_BIT,
+		EGL_RED_SIZE, 8, EGL_GREEN_SIZE, 8, EGL_BLUE_SIZE, 8, EGL_ALPHA_SIZE, 8,
+		EGL_NONE
+	};
+	EGLConfig config;
+	EGLint configCount = 0;
+	if (!eglChooseConfig(m_Display, configAttributes, &config, 1, &configCount) || configCount == 0)
+	{
+		Log::Error("No EGL config can render OpenGL offscreen!");
+		return false;
+	}
+
+	//Debug builds ask for a debug context like the windowed path, so GLDebugOutput can take over error checking
+	const EGLint contextAttributes[] = {
+		EGL_CONTEXT_MAJOR_VERSION_KHR, majorVersion,
+		EGL_CONTEXT_MINOR_VERSION_KHR, minorVersion,
+		EGL_CONTEXT_OPENGL_PROFILE_MASK_KHR, EGL_CONTEXT_OPENGL_CORE_PROFILE_BIT_KHR,
+#if GL_CHECK_POLICY == GL_CHECK_FULL
+		EGL_CONTEXT_FLAGS_KHR, EGL_CONTEXT_OPENGL_DEBUG_BIT_KHR,
+#endif
+		EGL_NONE
+	};
+	m_Context = eglCreateContext(m_Display, config, EGL_NO_CONTEXT, contextAttributes);
+	if (m_Context == EGL_NO_CONTEXT)
+	{
+		Log::Error("Failed to create an OpenGL {}.{} context ({})!", majorVersion, minorVersion, eglGetError());
+		return false;
+	}
+
+	//Everything is drawn into framebuffers, so a surface is only made for drivers that insist on one
+	if (!HasExtension(eglQueryString(m_Display, EGL_EXTENSIONS), "EGL_KHR_surfaceless_context"))
+	{
+		const EGLint surfaceAttributes[] = { EGL_WIDTH, 1, EGL_HEIGHT, 1, EGL_NONE };
+		m_Surface = eglCreatePbufferSurface(m_Display, config, surfaceAttributes);
+	}
+	if (!eglMakeCurrent(m_Display, m_Surface, m_Surface, m_Context))
+	{
+		Log::Error("Failed to make the headless context current ({})!", eglGetError());
+		return false;
+	}
+
+	m_Valid = true;
+	return true;
+}
+
+#else
+
+#include <GLFW/glfw3.h>
+
+HeadlessContext::HeadlessContext()
+	: m_Window(nullptr), m_Valid(false)
+{
+}
+
+HeadlessContext::~HeadlessContext()
+{
+	if (m_Window)
+		glfwDestroyWindow(m_Window);
+	glfwTerminate();
+}
+
+bool HeadlessContext::Create(int majorVersion, int minorVersion)
+{
+	if (!glfwInit())
+	{
+		Log::Error("Failed to initialise GLFW!");
+		return false;
+	}
+
+	//The window is never shown, it only exists to own the context
+	glfwWindowHint(GLFW_VISIBLE, GLFW_FALSE);
+	glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, majorVersion);
+	glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, minorVersion);
+	glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
+#if GL_CHECK_POLICY == GL_CHECK_FULL
+	glfwWindowHint(GLFW_OPENGL_DEBUG_CONTEXT, GLFW_TRUE);
+#endif
+	m_Window = glfwCreateWindow(1, 1, "Headless", nullptr, nullptr);
+	if (!m_Window)
+	{
+		Log::Error("Failed to create a hidden window for the headless context!");
+		return false;
+	}
+
+	glfwMakeContextCurrent(m_Window);
+	m_Valid = true;
+	return true;
+}
+
+#endif
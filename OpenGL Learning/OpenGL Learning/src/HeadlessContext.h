@@ -0,0 +1,33 @@
+#pragma once
+
+struct GLFWwindow;
+
+//A GL context with no window to draw into, for running the renderer on machines without a display. Everything
+//is drawn into a Framebuffer instead. Built with HEADLESS_EGL defined the context comes from EGL, which on
+//Linux works without any display server: Mesa's surfaceless platform is used when it is there, so llvmpipe
+//renders on machines with no GPU at all. Without it a hidden GLFW window provides the context, which is all
+//Windows needs.
+class HeadlessContext
+{
+private:
+#ifdef HEADLESS_EGL
+	void* m_Display;
+	void* m_Context;
+	void* m_Surface;
+#else
+	GLFWwindow* m_Window;
+#endif
+	bool m_Valid;
+
+public:
+	HeadlessContext();
+	~HeadlessContext();
+
+	HeadlessContext(const HeadlessContext&) = delete;
+	HeadlessContext& operator=(const HeadlessContext&) = delete;
+
+	//Creates a core profile context of the given version and makes it current
+	bool Create(int majorVersion = 3, int minorVersion = 3);
+
+	inline bool IsValid() const { return m_Valid; }
+};
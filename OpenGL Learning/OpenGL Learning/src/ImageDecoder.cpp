@@ -0,0 +1,100 @@
+#include "ImageDecoder.h"
+#include "MappedFile.h"
+#include "PngDecoder.h"
+#include "stb_image/stb_image.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+#include <thread>
+
+namespace {
+
+thread_local std::string s_FailureReason;
+
+unsigned char* Fail(const std::string& reason)
+{
+	s_FailureReason = reason;
+	return nullptr;
+}
+
+//stb_image's own flip is a global, so it is never turned on and stb results are flipped here instead
+void FlipRows(unsigned char* pixels, int width, int height, int channels)
+{
+	const size_t rowSize = (size_t)width * channels;
+	std::vector<unsigned char> temp(rowSize);
+	for (int y = 0; y < height / 2; y++)
+	{
+		unsigned char* top = pixels + y * rowSize;
+		unsigned char* bottom = pixels + (height - 1 - y) * rowSize;
+		memcpy(temp.data(), top, rowSize);
+		memcpy(top, bottom, rowSize);
+		memcpy(bottom, temp.data(), rowSize);
+	}
+}
+
+}
+
+unsigned char* DecodeImageFile(const std::string& path, int& width, int& height, int& channels, int desiredChannels, bool flip)
+{
+	MappedFile file(path);
+	if (!file.IsOpen())
+		return Fail("can't open file");
+	if (file.GetSize() > (size_t)INT32_MAX)
+		return Fail("file too large");
+
+	const char* error = nullptr;
+	if (IsPng(file.GetData(), file.GetSize()))
+	{
+		unsigned char* pixels = DecodePng(file.GetData(), file.GetSize(), &width, &height, &channels, desiredChannels, flip, &error);
+		if (pixels)
+			return pixels;
+	}
+
+	unsigned char* pixels = stbi_load_from_memory(file.GetData(), (int)file.GetSize(), &width, &height, &channels, desiredChannels);
+	if (!pixels)
+		return Fail(error ? error : stbi_failure_reason());
+
+	if (flip)
+		FlipRows(pixels, width, height, desiredChannels != 0 ? desiredChannels : channels);
+	return pixels;
+}
+
+void FreeImagePixels(unsigned char* pixels)
+{
+	//Both decoders allocate with malloc
+	stbi_image_free(pixels);
+}
+
+const char* GetImageFailureReason()
+{
+	return s_FailureReason.c_str();
+}
+
+std::vector<DecodedImageFile> DecodeImageFiles(const std::vector<std::string>& paths, int desiredChannels, bool flip)
+{
+	std::vector<DecodedImageFile> images(paths.size());
+	std::atomic<size_t> next(0);
+
+	auto decode = [&]()
+	{
+		for (size_t i = next++; i < paths.size(); i = next++)
+		{
+			DecodedImageFile& image = images[i];
+			image.Pixels = DecodeImageFile(paths[i], image.Width, image.Height, image.Channels, desiredChannels, flip);
+			if (!image.Pixels)
+				image.FailureReason = GetImageFailureReason();
+		}
+	};
+
+	const size_t threadCount = std::min<size_t>(std::max(1u, std::thread::hardware_concurrency()), paths.size());
+	std::vector<std::thread> threads;
+	for (size_t i = 1; i < threadCount; i++)
+		threads.emplace_back(decode);
+	decode();
+	for (std::thread& thread : threads)
+		thread.join();
+
+	return images;
+}
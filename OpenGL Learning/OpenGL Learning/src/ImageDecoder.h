@@ -0,0 +1,24 @@
+#pragma once
+
+#include <string>
+#include <vector>
+
+//Every image the project reads from disk comes through here. PNGs go through the in-house PngDecoder, anything
+//else, and the rare PNG it doesn't handle, through stb_image. The file is memory mapped rather than read, and
+//flip turns the image bottom row first the way OpenGL expects it. Unlike stbi_set_flip_vertically_on_load
+//that is per call, so threads decoding at the same time don't share any state.
+//desiredChannels 0 keeps what the file holds, channels is always what the file holds. The pixels are freed
+//with FreeImagePixels and on failure GetImageFailureReason says why on the calling thread.
+unsigned char* DecodeImageFile(const std::string& path, int& width, int& height, int& channels, int desiredChannels = 0, bool flip = true);
+void FreeImagePixels(unsigned char* pixels);
+const char* GetImageFailureReason();
+
+struct DecodedImageFile
+{
+	unsigned char* Pixels; //Null if the file couldn't be decoded
+	int Width, Height, Channels;
+	std::string FailureReason;
+};
+
+//Decodes the files across all hardware threads, in the same order as paths
+std::vector<DecodedImageFile> DecodeImageFiles(const std::vector<std::string>& paths, int desiredChannels = 0, bool flip = true);
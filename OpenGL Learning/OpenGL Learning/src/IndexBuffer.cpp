@@ -1,14 +1,17 @@
 #include "IndexBuffer.h"
 #include "Renderer.h"
+#include "RenderStats.h"
 
 IndexBuffer::IndexBuffer(const unsigned int* data, unsigned int count)
 	: m_Count(count)
 {	
-	ASSERT(sizeof(unsigned int) == sizeof(GLuint))
+	ASSERT(sizeof(unsigned int) == sizeof(GLuint));
 	
 	GLCall(glGenBuffers(1, &m_RendererID)); //This generates a buffer that the GPU can use to draw to the screen
 	GLCall(glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, m_RendererID)); //This Selects the buffer that we just created	
 	GLCall(glBufferData(GL_ELEMENT_ARRAY_BUFFER, count * sizeof(unsigned int), data, GL_STATIC_DRAW)); //This added the data to the buffer as STATIC meaning that the data won't change but can be called multiple times
+	RenderStats::Current().BuffersCreated++;
+	RenderStats::Current().BufferBytesUploaded += count * sizeof(unsigned int);
 }
 
 IndexBuffer::~IndexBuffer()
@@ -0,0 +1,294 @@
+#include "Log.h"
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdio>
+#include <iostream>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+LogLevel Log::s_MinimumLevel = LogLevel::Info;
+
+namespace
+{
+	enum ArgumentTag : unsigned char
+	{
+		SignedTag,
+		UnsignedTag,
+		FloatTag,
+		CharTag,
+		StringTag
+	};
+
+	//Head is only written by the owning thread and Tail only by the writer, each publishing with release
+	struct ThreadBuffer
+	{
+		Log::Record Records[Log::RecordsPerThread];
+		std::atomic<unsigned int> Head, Tail;
+		std::atomic<unsigned int> Dropped;
+	};
+
+	class LogWriter
+	{
+	private:
+		std::mutex m_Mutex;
+		std::condition_variable m_Condition, m_Flushed;
+		std::vector<ThreadBuffer*> m_Buffers; //Never freed, a thread that exits may still have messages waiting
+		unsigned long long m_Passes;
+		bool m_FlushRequested, m_Running;
+		std::thread m_Thread;
+
+	public:
+		LogWriter()
+			: m_Passes(0), m_FlushRequested(false), m_Running(true)
+		{
+			m_Thread = std::thread(&LogWriter::Run, this);
+		}
+
+		//Static destruction prints whatever is left
+		~LogWriter()
+		{
+			{
+				std::lock_guard<std::mutex> lock(m_Mutex);
+				m_Running = false;
+			}
+			m_Condition.notify_one();
+			m_Thread.join();
+		}
+
+		ThreadBuffer* AddBuffer()
+		{
+			//Default initialised so the records aren't zeroed
+			ThreadBuffer* buffer = new ThreadBuffer;
+			buffer->Head.store(0);
+			buffer->Tail.store(0);
+			buffer->Dropped.store(0);
+
+			std::lock_guard<std::mutex> lock(m_Mutex);
+			m_Buffers.push_back(buffer);
+			return buffer;
+		}
+
+		//Two whole passes after the request guarantee one that started after it
+		void Flush()
+		{
+			std::unique_lock<std::mutex> lock(m_Mutex);
+			const unsigned long long target = m_Passes + 2;
+			m_FlushRequested = true;
+			m_Condition.notify_one();
+			m_Flushed.wait(lock, [this, target] { return m_Passes >= target || !m_Running; });
+		}
+
+	private:
+		void Run()
+		{
+			std::string text;
+			bool running = true;
+			while (running)
+			{
+				std::vector<ThreadBuffer*> buffers;
+				{
+					std::unique_lock<std::mutex> lock(m_Mutex);
+					m_Condition.wait_for(lock, std::chrono::milliseconds(5), [this] { return !m_Running || m_FlushRequested; });
+					m_FlushRequested = false;
+					running = m_Running;
+					buffers = m_Buffers;
+				}
+
+				unsigned int dropped = 0;
+				for (ThreadBuffer* buffer : buffers)
+				{
+					const unsigned int head = buffer->Head.load(std::memory_order_acquire);
+					unsigned int tail = buffer->Tail.load(std::memory_order_relaxed);
+					for (; tail != head; tail++)
+					{
+						Format(buffer->Records[tail % Log::RecordsPerThread], text);
+						text += '\n';
+					}
+					buffer->Tail.store(tail, std::memory_order_release);
+					dropped += buffer->Dropped.exchange(0, std::memory_order_relaxed);
+				}
+				if (dropped)
+					text += std::to_string(dropped) + " log messages dropped, the log couldn't keep up\n";
+
+				//One write and flush for the whole batch
+				if (!text.empty())
+				{
+					std::cout.write(text.data(), text.size());
+					std::cout.flush();
+					text.clear();
+				}
+
+				{
+					std::lock_guard<std::mutex> lock(m_Mutex);
+					m_Passes++;
+				}
+				m_Flushed.notify_all();
+			}
+		}
+
+		static void Format(const Log::Record& record, std::string& text)
+		{
+			size_t offset = 0;
+			for (const char* c = record.Format; *c; c++)
+			{
+				if (c[0] != '{' || c[1] != '}')
+				{
+					text += *c;
+					continue;
+				}
+				c++;
+
+				if (offset >= record.Size)
+				{
+					text += "{?}";
+					continue;
+				}
+				const unsigned char* data = record.Data + offset;
+				char number[32];
+				switch (data[0])
+				{
+					case SignedTag:
+					{
+						long long value;
+						memcpy(&value, data + 1, sizeof(value));
+						text += std::to_string(value);
+						offset += 1 + sizeof(value);
+						break;
+					}
+					case UnsignedTag:
+					{
+						unsigned long long value;
+						memcpy(&value, data + 1, sizeof(value));
+						text += std::to_string(value);
+						offset += 1 + sizeof(value);
+						break;
+					}
+					case FloatTag:
+					{
+						//Same as a stream's default formatting
+						double value;
+						memcpy(&value, data + 1, sizeof(value));
+						snprintf(number, sizeof(number), "%g", value);
+						text += number;
+						offset += 1 + sizeof(value);
+						break;
+					}
+					case CharTag:
+						text += (char)data[1];
+						offset += 2;
+						break;
+					case StringTag:
+					{
+						uint16_t length;
+						memcpy(&length, data + 1, sizeof(length));
+						text.append((const char*)data + 1 + sizeof(length), length);
+						offset += 1 + sizeof(length) + length;
+						break;
+					}
+				}
+			}
+		}
+	};
+
+	LogWriter& GetWriter()
+	{
+		static LogWriter writer;
+		return writer;
+	}
+
+	thread_local ThreadBuffer* t_Buffer = nullptr;
+
+	bool Reserve(Log::Record& record, size_t size)
+	{
+		return record.Size + size <= sizeof(record.Data);
+	}
+}
+
+Log::Record* Log::BeginRecord(LogLevel level, const char* format)
+{
+	if (!t_Buffer)
+		t_Buffer = GetWriter().AddBuffer();
+
+	const unsigned int head = t_Buffer->Head.load(std::memory_order_relaxed);
+	if (head - t_Buffer->Tail.load(std::memory_order_acquire) == RecordsPerThread)
+	{
+		t_Buffer->Dropped.fetch_add(1, std::memory_order_relaxed);
+		return nullptr;
+	}
+
+	Record& record = t_Buffer->Records[head % RecordsPerThread];
+	record.Format = format;
+	record.Level = level;
+	record.Size = 0;
+	return &record;
+}
+
+void Log::EndRecord()
+{
+	t_Buffer->Head.store(t_Buffer->Head.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+}
+
+void Log::Flush()
+{
+	GetWriter().Flush();
+}
+
+//An argument that doesn't fit is left out and printed as {?}
+void Log::AppendSigned(Record& record, long long value)
+{
+	if (!Reserve(record, 1 + sizeof(value)))
+		return;
+	record.Data[record.Size] = SignedTag;
+	memcpy(record.Data + record.Size + 1, &value, sizeof(value));
+	record.Size += 1 + sizeof(value);
+}
+
+void Log::AppendUnsigned(Record& record, unsigned long long value)
+{
+	if (!Reserve(record, 1 + sizeof(value)))
+		return;
+	record.Data[record.Size] = UnsignedTag;
+	memcpy(record.Data + record.Size + 1, &value, sizeof(value));
+	record.Size += 1 + sizeof(value);
+}
+
+void Log::AppendFloat(Record& record, double value)
+{
+	if (!Reserve(record, 1 + sizeof(value)))
+		return;
+	record.Data[record.Size] = FloatTag;
+	memcpy(record.Data + record.Size + 1, &value, sizeof(value));
+	record.Size += 1 + sizeof(value);
+}
+
+void Log::AppendChar(Record& record, char value)
+{
+	if (!Reserve(record, 2))
+		return;
+	record.Data[record.Size] = CharTag;
+	record.Data[record.Size + 1] = (unsigned char)value;
+	record.Size += 2;
+}
+
+//Keeps the end of a string that is too long, for paths that's the part that matters
+void Log::AppendString(Record& record, const char* value, size_t length)
+{
+	const size_t header = 1 + sizeof(uint16_t);
+	if (!Reserve(record, header))
+		return;
+	const size_t space = sizeof(record.Data) - record.Size - header;
+	if (length > space)
+	{
+		value += length - space;
+		length = space;
+	}
+
+	const uint16_t storedLength = (uint16_t)length;
+	record.Data[record.Size] = StringTag;
+	memcpy(record.Data + record.Size + 1, &storedLength, sizeof(storedLength));
+	memcpy(record.Data + record.Size + header, value, length);
+	record.Size += (uint16_t)(header + length);
+}
@@ -0,0 +1,105 @@
+#pragma once
+
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <string_view>
+#include <type_traits>
+
+enum class LogLevel : uint8_t
+{
+	Info,
+	Warning,
+	Error
+};
+
+//Logging that never waits on the console. Each thread writes into its own single producer ring of fixed size
+//records and a writer thread prints them in batches. Arguments are copied into the record as they are and only
+//turned into text on the writer thread. When a thread's ring is full the message is dropped and counted rather
+//than blocking the thread. Formats use {} for each argument: Log::Error("Failed to open {}!", path). The format
+//itself isn't copied, so it has to be a string literal.
+class Log
+{
+public:
+	static const unsigned int RecordSize = 256; //Long string arguments are cut short to fit
+	static const unsigned int RecordsPerThread = 256;
+
+	struct Record
+	{
+		const char* Format;
+		LogLevel Level;
+		uint16_t Size; //Bytes of Data used
+		unsigned char Data[RecordSize - sizeof(const char*) - 4]; //Each argument is a type tag followed by its value
+	};
+
+private:
+	static LogLevel s_MinimumLevel;
+
+public:
+	template<typename... Args>
+	static void Info(const char* format, const Args&... args) { Write(LogLevel::Info, format, args...); }
+	template<typename... Args>
+	static void Warning(const char* format, const Args&... args) { Write(LogLevel::Warning, format, args...); }
+	template<typename... Args>
+	static void Error(const char* format, const Args&... args) { Write(LogLevel::Error, format, args...); }
+
+	template<typename... Args>
+	static void Write(LogLevel level, const char* format, const Args&... args)
+	{
+		if (level < s_MinimumLevel)
+			return;
+
+		Record* record = BeginRecord(level, format);
+		if (!record)
+			return;
+		(Append(*record, args), ...);
+		EndRecord();
+	}
+
+	//Waits until everything logged before the call has been printed, for just before the program may stop
+	static void Flush();
+
+	//Messages below this are skipped before anything is copied
+	static inline void SetMinimumLevel(LogLevel level) { s_MinimumLevel = level; }
+
+private:
+	static Record* BeginRecord(LogLevel level, const char* format);
+	static void EndRecord();
+
+	static void AppendSigned(Record& record, long long value);
+	static void AppendUnsigned(Record& record, unsigned long long value);
+	static void AppendFloat(Record& record, double value);
+	static void AppendChar(Record& record, char value);
+	static void AppendString(Record& record, const char* value, size_t length);
+
+	template<typename T>
+	static void Append(Record& record, const T& value)
+	{
+		if constexpr (std::is_same_v<T, std::string> || std::is_same_v<T, std::string_view>)
+			AppendString(record, value.data(), value.size());
+		else if constexpr (std::is_same_v<T, char>)
+			AppendChar(record, value);
+		else if constexpr (std::is_same_v<T, bool>)
+			AppendSigned(record, value ? 1 : 0);
+		else if constexpr (std::is_enum_v<T>)
+			AppendSigned(record, (long long)value);
+		else if constexpr (std::is_integral_v<T> && std::is_signed_v<T>)
+			AppendSigned(record, value);
+		else if constexpr (std::is_integral_v<T>)
+			AppendUnsigned(record, value);
+		else if constexpr (std::is_floating_point_v<T>)
+			AppendFloat(record, value);
+		else if constexpr (std::is_convertible_v<const T&, const char*>)
+		{
+			const char* text = value;
+			AppendString(record, text, text ? strlen(text) : 0);
+		}
+		else if constexpr (std::is_convertible_v<const T&, const unsigned char*>) //glGetString
+		{
+			const char* text = (const char*)(const unsigned char*)value;
+			AppendString(record, text, text ? strlen(text) : 0);
+		}
+		else
+			static_assert(!sizeof(T), "Log can't print this type");
+	}
+};
@@ -0,0 +1,304 @@
+#include "MipChain.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define MIPCHAIN_SSE2
+#include <emmintrin.h>
+#endif
+
+namespace {
+
+//sRGB byte to linear float, a plain byte to a 0..1 float and a 12 bit linear index back to the sRGB byte
+struct GammaTables
+{
+	float ToLinear[256];
+	float ToFloat[256];
+	unsigned char ToSRGB[4096];
+
+	GammaTables()
+	{
+		for (int i = 0; i < 256; i++)
+		{
+			float c = i / 255.0f;
+			ToLinear[i] = c <= 0.04045f ? c / 12.92f : std::pow((c + 0.055f) / 1.055f, 2.4f);
+			ToFloat[i] = c;
+		}
+		for (int i = 0; i < 4096; i++)
+		{
+			float l = i / 4095.0f;
+			float c = l <= 0.0031308f ? l * 12.92f : 1.055f * std::pow(l, 1.0f / 2.4f) - 0.055f;
+			ToSRGB[i] = (unsigned char)std::min(255.0f, c * 255.0f + 0.5f);
+		}
+	}
+};
+
+const GammaTables& GetGammaTables()
+{
+	static GammaTables tables;
+	return tables;
+}
+
+using Taps = MipChain::Taps;
+
+//Every channel is kept on a 0..1 linear scale so colour and alpha can share the same filtering code.
+//tables holds the table of each lane of a group of four, see EncodeRow for why that pattern fits any channel count
+void DecodeRow(const unsigned char* src, size_t length, const float* const tables[4], float* out)
+{
+	size_t i = 0;
+	for (; i + 4 <= length; i += 4)
+	{
+		out[i] = tables[0][src[i]];
+		out[i + 1] = tables[1][src[i + 1]];
+		out[i + 2] = tables[2][src[i + 2]];
+		out[i + 3] = tables[3][src[i + 3]];
+	}
+	for (; i < length; i++)
+		out[i] = tables[i % 4][src[i]];
+}
+
+//out = the sum of rows[k] * weights[k], four floats at a time whatever the channel count
+void BlendRows(const float* const rows[3], const float* weights, int count, size_t length, float* out)
+{
+	for (int k = 0; k < count; k++)
+	{
+		const float* row = rows[k];
+		const float weight = weights[k];
+		size_t i = 0;
+#ifdef MIPCHAIN_SSE2
+		const __m128 weights4 = _mm_set1_ps(weight);
+		for (; i + 4 <= length; i += 4)
+		{
+			__m128 value = _mm_mul_ps(_mm_loadu_ps(row + i), weights4);
+			if (k > 0)
+				value = _mm_add_ps(value, _mm_loadu_ps(out + i));
+			_mm_storeu_ps(out + i, value);
+		}
+#endif
+		for (; i < length; i++)
+			out[i] = (k > 0 ? out[i] : 0.0f) + row[i] * weight;
+	}
+}
+
+void FilterRow(const float* src, const std::vector<Taps>& taps, int channels, float* out)
+{
+	for (size_t x = 0; x < taps.size(); x++)
+	{
+		const Taps& tap = taps[x];
+		const float* texel = src + (size_t)tap.First * channels;
+		float* result = out + x * channels;
+#ifdef MIPCHAIN_SSE2
+		//An RGBA texel fills a register, so each tap is one multiply and add
+		if (channels == 4)
+		{
+			__m128 sum = _mm_mul_ps(_mm_loadu_ps(texel), _mm_set1_ps(tap.Weights[0]));
+			for (int k = 1; k < tap.Count; k++)
+				sum = _mm_add_ps(sum, _mm_mul_ps(_mm_loadu_ps(texel + k * 4), _mm_set1_ps(tap.Weights[k])));
+			_mm_storeu_ps(result, sum);
+			continue;
+		}
+#endif
+		for (int c = 0; c < channels; c++)
+		{
+			float sum = 0.0f;
+			for (int k = 0; k < tap.Count; k++)
+				sum += texel[k * channels + c] * tap.Weights[k];
+			result[c] = sum;
+		}
+	}
+}
+
+//Colour goes back through the 12 bit sRGB table and everything else straight to a byte. The scale to
+//table index or byte is done four floats at a time, the lane pattern repeats because 1, 2 and 4 channel
+//rows line up with a register and 3 channel rows scale every channel the same
+void EncodeRow(const float* values, int width, int channels, int colourChannels, const GammaTables& tables, int* indices, unsigned char* out)
+{
+	float scales[4];
+	for (int i = 0; i < 4; i++)
+		scales[i] = (i % channels) < colourChannels ? 4095.0f : 255.0f;
+
+	const size_t length = (size_t)width * channels;
+	size_t i = 0;
+#ifdef MIPCHAIN_SSE2
+	const __m128 scale = _mm_loadu_ps(scales);
+	const __m128 half = _mm_set1_ps(0.5f);
+	for (; i + 4 <= length; i += 4)
+	{
+		__m128 value = _mm_min_ps(_mm_mul_ps(_mm_loadu_ps(values + i), scale), scale);
+		_mm_storeu_si128((__m128i*)(indices + i), _mm_cvttps_epi32(_mm_add_ps(value, half)));
+	}
+#endif
+	for (; i < length; i++)
+		indices[i] = (int)(std::min(values[i] * scales[i % 4], scales[i % 4]) + 0.5f);
+
+	bool colour[4];
+	for (int c = 0; c < 4; c++)
+		colour[c] = (c % channels) < colourChannels;
+	for (i = 0; i < length; i++)
+		out[i] = colour[i % 4] ? tables.ToSRGB[indices[i]] : (unsigned char)indices[i];
+}
+
+}
+
+MipChain::Taps MipChain::GetTaps(int index, int srcSize)
+{
+	if (srcSize == 1)
+		return { 0, 1, { 1.0f, 0.0f, 0.0f } };
+	if (srcSize % 2 == 0)
+		return { index * 2, 2, { 0.5f, 0.5f, 0.0f } };
+
+	const int dstSize = srcSize / 2;
+	const float scale = 1.0f / srcSize;
+	return { index * 2, 3, { (dstSize - index) * scale, dstSize * scale, (index + 1) * scale } };
+}
+
+MipChain::RowFilter::RowFilter(int srcWidth, int channels, bool srgb)
+	: m_SrcWidth(srcWidth), m_Width(std::max(1, srcWidth / 2)), m_Channels(channels), m_DecodedRows{ -1, -1, -1 }
+{
+	const GammaTables& tables = GetGammaTables();
+	m_ColourChannels = srgb ? ((channels == 2 || channels == 4) ? channels - 1 : channels) : 0;
+	for (int c = 0; c < 4; c++)
+		m_Tables[c] = (c % channels) < m_ColourChannels ? tables.ToLinear : tables.ToFloat;
+
+	m_Columns.resize(m_Width);
+	for (int x = 0; x < m_Width; x++)
+		m_Columns[x] = GetTaps(x, srcWidth);
+
+	//Odd heights share a row between neighbouring output rows, so the last three decoded rows are kept
+	const size_t srcLength = (size_t)srcWidth * channels;
+	m_Decoded.resize(srcLength * 3);
+	m_Blended.resize(srcLength);
+	m_Filtered.resize((size_t)m_Width * channels);
+	m_Indices.resize((size_t)m_Width * channels);
+}
+
+//Each source row is linearised once, blended vertically with its neighbours a whole row at a time and then
+//filtered horizontally and encoded
+void MipChain::RowFilter::Filter(const Taps& taps, const unsigned char* const* rows, unsigned char* out)
+{
+	const size_t srcLength = (size_t)m_SrcWidth * m_Channels;
+	const float* rowData[3];
+	for (int k = 0; k < taps.Count; k++)
+	{
+		const int row = taps.First + k;
+		float* slot = m_Decoded.data() + (row % 3) * srcLength;
+		if (m_DecodedRows[row % 3] != row)
+		{
+			DecodeRow(rows[k], srcLength, m_Tables, slot);
+			m_DecodedRows[row % 3] = row;
+		}
+		rowData[k] = slot;
+	}
+
+	BlendRows(rowData, taps.Weights, taps.Count, srcLength, m_Blended.data());
+	FilterRow(m_Blended.data(), m_Columns, m_Channels, m_Filtered.data());
+	EncodeRow(m_Filtered.data(), m_Width, m_Channels, m_ColourChannels, GetGammaTables(), m_Indices.data(), out);
+}
+
+MipChain MipChain::Generate(const unsigned char* pixels, int width, int height, int channels, bool srgb)
+{
+	MipChain chain;
+	chain.m_Channels = channels;
+	chain.m_SRGB = srgb;
+
+	const unsigned char* src = pixels;
+	int srcWidth = width, srcHeight = height;
+	while (srcWidth > 1 || srcHeight > 1)
+	{
+		Level level;
+		level.Width = std::max(1, srcWidth / 2);
+		level.Height = std::max(1, srcHeight / 2);
+		level.Pixels.resize((size_t)level.Width * level.Height * channels);
+		RowFilter filter(srcWidth, channels, srgb);
+		const size_t srcLength = (size_t)srcWidth * channels;
+		for (int y = 0; y < level.Height; y++)
+		{
+			const Taps taps = GetTaps(y, srcHeight);
+			const unsigned char* rows[3];
+			for (int k = 0; k < taps.Count; k++)
+				rows[k] = src + (taps.First + k) * srcLength;
+			filter.Filter(taps, rows, level.Pixels.data() + (size_t)y * level.Width * channels);
+		}
+
+		chain.m_Levels.push_back(std::move(level));
+		src = chain.m_Levels.back().Pixels.data();
+		srcWidth = chain.m_Levels.back().Width;
+		srcHeight = chain.m_Levels.back().Height;
+	}
+	return chain;
+}
+
+namespace {
+
+struct CacheHeader
+{
+	char Magic[4];
+	uint32_t Version;
+	uint32_t Width, Height, Channels, SRGB, LevelCount;
+	int64_t SourceWriteTime;
+};
+
+const uint32_t CacheVersion = 3; //2 weights odd sizes over three texels, 3 records whether colour was linearised
+
+int64_t GetWriteTime(const std::string& path)
+{
+	std::error_code error;
+	auto time = std::filesystem::last_write_time(path, error);
+	return error ? 0 : (int64_t)time.time_since_epoch().count();
+}
+
+}
+
+bool MipChain::Load(const std::string& cachePath, const std::string& sourcePath, int width, int height, int channels, bool srgb)
+{
+	std::ifstream stream(cachePath, std::ios::binary);
+	if (!stream)
+		return false;
+
+	CacheHeader header;
+	if (!stream.read((char*)&header, sizeof(header)))
+		return false;
+
+	if (std::string(header.Magic, 4) != "MIPS" || header.Version != CacheVersion ||
+		header.Width != (uint32_t)width || header.Height != (uint32_t)height || header.Channels != (uint32_t)channels ||
+		header.SRGB != (srgb ? 1u : 0u) || header.SourceWriteTime != GetWriteTime(sourcePath))
+		return false;
+
+	std::vector<Level> levels;
+	int levelWidth = width, levelHeight = height;
+	for (uint32_t i = 0; i < header.LevelCount; i++)
+	{
+		Level level;
+		level.Width = levelWidth = std::max(1, levelWidth / 2);
+		level.Height = levelHeight = std::max(1, levelHeight / 2);
+		level.Pixels.resize((size_t)level.Width * level.Height * channels);
+		if (!stream.read((char*)level.Pixels.data(), level.Pixels.size()))
+			return false;
+
+		levels.push_back(std::move(level));
+	}
+
+	m_Channels = channels;
+	m_SRGB = srgb;
+	m_Levels = std::move(levels);
+	return true;
+}
+
+bool MipChain::Save(const std::string& cachePath, const std::string& sourcePath, int width, int height) const
+{
+	std::ofstream stream(cachePath, std::ios::binary | std::ios::trunc);
+	if (!stream)
+		return false;
+
+	CacheHeader header = { { 'M', 'I', 'P', 'S' }, CacheVersion, (uint32_t)width, (uint32_t)height,
+		(uint32_t)m_Channels, m_SRGB ? 1u : 0u, (uint32_t)m_Levels.size(), GetWriteTime(sourcePath) };
+	stream.write((const char*)&header, sizeof(header));
+	for (const auto& level : m_Levels)
+		stream.write((const char*)level.Pixels.data(), level.Pixels.size());
+
+	return (bool)stream;
+}
@@ -0,0 +1,70 @@
+#pragma once
+
+#include <string>
+#include <vector>
+
+//The levels below level 0 of an 8 bit per channel image, built on the CPU with a gamma correct box filter that
+//averages 2 texels along even sides and 3 weighted ones along odd sides, so no source row or column is dropped.
+//Colour channels are averaged in linear space and alpha (the last channel of 2 and 4 channel images) as is,
+//which keeps minified textures from going darker than they should. Chains can be cached next to their source.
+class MipChain
+{
+public:
+	struct Level
+	{
+		int Width, Height;
+		std::vector<unsigned char> Pixels;
+	};
+
+	//Which texels of the level above, and how much of each, make up one texel of the next level along an axis
+	struct Taps
+	{
+		int First, Count;
+		float Weights[3];
+	};
+
+	//Builds the next level a row at a time, for images too big to hold whole. Row y is made from rows
+	//GetTaps(y, srcHeight) of the level above, the last three of which are decoded once and kept
+	class RowFilter
+	{
+	private:
+		int m_SrcWidth, m_Width, m_Channels, m_ColourChannels;
+		const float* m_Tables[4];
+		std::vector<Taps> m_Columns;
+		std::vector<float> m_Decoded, m_Blended, m_Filtered;
+		std::vector<int> m_Indices;
+		int m_DecodedRows[3];
+
+	public:
+		RowFilter(int srcWidth, int channels, bool srgb = true);
+
+		//rows[k] is source row taps.First + k, out gets the row's GetWidth() texels
+		void Filter(const Taps& taps, const unsigned char* const* rows, unsigned char* out);
+
+		inline int GetWidth() const { return m_Width; }
+	};
+
+private:
+	int m_Channels;
+	bool m_SRGB;
+	std::vector<Level> m_Levels;
+
+public:
+	MipChain()
+		: m_Channels(0), m_SRGB(true) {}
+
+	//Halves the image down to 1x1, rows are tightly packed. Data that isn't colour, like normal maps
+	//or masks, should pass srgb = false so every channel is averaged as is
+	static MipChain Generate(const unsigned char* pixels, int width, int height, int channels, bool srgb = true);
+
+	//Levels are floor(size / 2) like GL's, so an even size averages pairs and an odd one spreads three texels over
+	//each texel of the next level, which keeps the last row and column in the chain
+	static Taps GetTaps(int index, int srcSize);
+
+	//Reads a chain saved by Save, fails if it doesn't match the image and filtering or the source file changed since
+	bool Load(const std::string& cachePath, const std::string& sourcePath, int width, int height, int channels, bool srgb = true);
+	bool Save(const std::string& cachePath, const std::string& sourcePath, int width, int height) const;
+
+	inline const std::vector<Level>& GetLevels() const { return m_Levels; }
+	inline int GetChannels() const { return m_Channels; }
+};
@@ -0,0 +1,907 @@
+#include "PngDecoder.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <functional>
+#include <memory>
+#include <new>
+#include <vector>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define PNGDECODER_SSE2
+#include <emmintrin.h>
+#endif
+
+namespace {
+
+//Inflate
+
+const int FastBits = 10; //Codes up to this long are decoded with a single lookup
+
+struct Huffman
+{
+	uint16_t Fast[1 << FastBits]; //Symbol << 4 | length, 0 when the code is longer than FastBits
+	uint16_t Counts[16];
+	uint16_t Symbols[288];
+
+	bool Build(const uint8_t* lengths, int count)
+	{
+		memset(Fast, 0, sizeof(Fast));
+		memset(Counts, 0, sizeof(Counts));
+		for (int i = 0; i < count; i++)
+			Counts[lengths[i]]++;
+		Counts[0] = 0;
+
+		//Canonical codes are handed out in order of length, then symbol
+		uint16_t offsets[16];
+		int code = 0, left = 1;
+		offsets[1] = 0;
+		for (int length = 1; length < 16; length++)
+		{
+			left = (left << 1) - Counts[length];
+			if (left < 0)
+				return false;
+			if (length < 15)
+				offsets[length + 1] = offsets[length] + Counts[length];
+		}
+		for (int i = 0; i < count; i++)
+		{
+			if (lengths[i])
+				Symbols[offsets[lengths[i]]++] = (uint16_t)i;
+		}
+
+		//The stream holds codes most significant bit first but is read least significant bit first,
+		//so every short code is reversed and spread over each table entry that starts with it
+		int next = 0;
+		for (int length = 1; length <= FastBits; length++)
+		{
+			for (int i = 0; i < Counts[length]; i++, code++)
+			{
+				int reversed = 0;
+				for (int bit = 0; bit < length; bit++)
+					reversed |= ((code >> bit) & 1) << (length - 1 - bit);
+				for (int entry = reversed; entry < (1 << FastBits); entry += 1 << length)
+					Fast[entry] = (uint16_t)((Symbols[next + i] << 4) | length);
+			}
+			next += Counts[length];
+			code <<= 1;
+		}
+		return true;
+	}
+};
+
+uint32_t ReadBigEndian(const uint8_t* p)
+{
+	return ((uint32_t)p[0] << 24) | ((uint32_t)p[1] << 16) | ((uint32_t)p[2] << 8) | p[3];
+}
+
+//Inflates the IDAT chunks where they are in the file, stepping to the next chunk whenever one runs out so split
+//streams are never joined into a copy. When Out fills up it stops, and Inflate can be called again to carry on
+//once the caller has made room, which is how images are decoded a band at a time
+struct Inflater
+{
+	enum class Result
+	{
+		Done, OutputFull, Error
+	};
+
+	enum class Step
+	{
+		BlockHeader, Stored, Codes, Finished
+	};
+
+	const uint8_t* File;
+	size_t FileSize, NextChunk;
+
+	const uint8_t* In;
+	const uint8_t* End;
+	uint64_t Bits;
+	int Count;
+	uint8_t* Out;
+	size_t OutSize, OutPosition;
+
+	//Where the stream left off when Out filled up, Remaining is what is left of a stored block or of a match
+	//that didn't fit
+	Step Current;
+	bool LastBlock;
+	size_t Remaining, Distance;
+	Huffman Lengths, Distances;
+
+	//Out needs 8 bytes of slack past OutSize
+	Inflater(const uint8_t* file, size_t fileSize, size_t firstChunk, uint8_t* out, size_t outSize)
+		: File(file), FileSize(fileSize), NextChunk(firstChunk), In(nullptr), End(nullptr), Bits(0), Count(0),
+		Out(out), OutSize(outSize), OutPosition(0), Current(Step::BlockHeader), LastBlock(false), Remaining(0), Distance(0)
+	{
+	}
+
+	bool NextInput()
+	{
+		while (NextChunk + 12 <= FileSize)
+		{
+			const uint32_t length = ReadBigEndian(File + NextChunk);
+			const uint8_t* type = File + NextChunk + 4;
+			const uint8_t* chunk = File + NextChunk + 8;
+			if (length > FileSize - NextChunk - 12)
+				break;
+			NextChunk += 12 + (size_t)length;
+			if (memcmp(type, "IEND", 4) == 0)
+				break;
+			if (memcmp(type, "IDAT", 4) == 0 && length > 0)
+			{
+				In = chunk;
+				End = chunk + length;
+				return true;
+			}
+		}
+		NextChunk = FileSize;
+		return false;
+	}
+
+	void Refill()
+	{
+		//Eight bytes at a time while there is room, byte by byte at the end of a chunk
+		if (End - In >= 8)
+		{
+			uint64_t value;
+			memcpy(&value, In, 8);
+			Bits |= value << Count;
+			In += (63 - Count) >> 3;
+			Count |= 56;
+		}
+		else
+		{
+			while (Count <= 56 && (In < End || NextInput()))
+			{
+				Bits |= (uint64_t)*In++ << Count;
+				Count += 8;
+			}
+		}
+	}
+
+	uint32_t GetBits(int count)
+	{
+		if (Count < count)
+			Refill();
+		uint32_t value = (uint32_t)(Bits & ((1ull << count) - 1));
+		Bits >>= count;
+		Count -= count;
+		return value;
+	}
+
+	int Decode(const Huffman& huffman)
+	{
+		if (Count < 16)
+			Refill();
+
+		uint16_t entry = huffman.Fast[Bits & ((1 << FastBits) - 1)];
+		if (entry)
+		{
+			Bits >>= entry & 15;
+			Count -= entry & 15;
+			return entry >> 4;
+		}
+
+		//Long codes walk the canonical code one bit at a time
+		int code = 0, first = 0, index = 0;
+		for (int length = 1; length < 16; length++)
+		{
+			code |= (int)(Bits & 1);
+			Bits >>= 1;
+			Count--;
+			int count = huffman.Counts[length];
+			if (code - first < count)
+				return huffman.Symbols[index + code - first];
+			index += count;
+			first = (first + count) << 1;
+			code <<= 1;
+		}
+		return -1;
+	}
+
+	//The two byte zlib header, the adler32 at the end isn't checked
+	bool Begin()
+	{
+		if (!NextInput())
+			return false;
+		uint32_t method = GetBits(8);
+		uint32_t flags = GetBits(8);
+		return (method & 15) == 8 && (flags & 32) == 0 && ((method << 8) | flags) % 31 == 0;
+	}
+
+	bool Stored()
+	{
+		//Whole bytes already in the bit buffer come first, Count stays a multiple of 8 for the whole block
+		while (Remaining > 0 && Count >= 8 && OutPosition < OutSize)
+		{
+			Out[OutPosition++] = (uint8_t)GetBits(8);
+			Remaining--;
+		}
+		if (Remaining == 0 || OutPosition == OutSize)
+			return true;
+
+		//Past Count the bit buffer can hold copies of bytes that are about to be copied directly, so it starts over
+		Bits = 0;
+		while (Remaining > 0 && OutPosition < OutSize)
+		{
+			if (In == End && !NextInput())
+				return false;
+			size_t length = std::min({ Remaining, (size_t)(End - In), OutSize - OutPosition });
+			memcpy(Out + OutPosition, In, length);
+			In += length;
+			OutPosition += length;
+			Remaining -= length;
+		}
+		return true;
+	}
+
+	Result Codes()
+	{
+		static const uint16_t lengthBase[29] = { 3, 4, 5, 6, 7, 8, 9, 10, 11, 13, 15, 17, 19, 23, 27, 31, 35, 43, 51, 59, 67, 83, 99, 115, 131, 163, 195, 227, 258 };
+		static const uint8_t lengthExtra[29] = { 0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 1, 1, 2, 2, 2, 2, 3, 3, 3, 3, 4, 4, 4, 4, 5, 5, 5, 5, 0 };
+		static const uint16_t distanceBase[30] = { 1, 2, 3, 4, 5, 7, 9, 13, 17, 25, 33, 49, 65, 97, 129, 193, 257, 385, 513, 769, 1025, 1537, 2049, 3073, 4097, 6145, 8193, 12289, 16385, 24577 };
+		static const uint8_t distanceExtra[30] = { 0, 0, 0, 0, 1, 1, 2, 2, 3, 3, 4, 4, 5, 5, 6, 6, 7, 7, 8, 8, 9, 9, 10, 10, 11, 11, 12, 12, 13, 13 };
+
+		while (true)
+		{
+			if (Remaining > 0)
+			{
+				if (OutPosition + Remaining > OutSize)
+					return Result::OutputFull;
+
+				//The output has 8 bytes of slack so long matches can be copied a word at a time when they don't overlap
+				uint8_t* destination = Out + OutPosition;
+				const uint8_t* source = destination - Distance;
+				if (Distance >= 8)
+				{
+					for (size_t i = 0; i < Remaining; i += 8)
+						memcpy(destination + i, source + i, 8);
+				}
+				else
+				{
+					for (size_t i = 0; i < Remaining; i++)
+						destination[i] = source[i];
+				}
+				OutPosition += Remaining;
+				Remaining = 0;
+			}
+			if (OutPosition == OutSize)
+				return Result::OutputFull;
+
+			int symbol = Decode(Lengths);
+			if (symbol < 256)
+			{
+				if (symbol < 0)
+					return Result::Error;
+				Out[OutPosition++] = (uint8_t)symbol;
+				continue;
+			}
+			if (symbol == 256)
+				return Result::Done;
+
+			symbol -= 257;
+			if (symbol >= 29)
+				return Result::Error;
+			Remaining = lengthBase[symbol] + GetBits(lengthExtra[symbol]);
+
+			int distanceSymbol = Decode(Distances);
+			if (distanceSymbol < 0 || distanceSymbol >= 30)
+				return Result::Error;
+			Distance = distanceBase[distanceSymbol] + GetBits(distanceExtra[distanceSymbol]);
+			if (Distance > OutPosition)
+				return Result::Error;
+		}
+	}
+
+	bool BlockHeader()
+	{
+		LastBlock = GetBits(1) != 0;
+		uint32_t type = GetBits(2);
+		if (type == 0)
+		{
+			//Stored blocks start on a byte boundary
+			GetBits(Count & 7);
+			uint32_t length = GetBits(16);
+			uint32_t inverse = GetBits(16);
+			if ((length ^ 0xFFFF) != inverse)
+				return false;
+			Remaining = length;
+			Current = Step::Stored;
+			return true;
+		}
+		if (type == 1)
+		{
+			uint8_t fixed[288 + 32];
+			memset(fixed, 8, 144);
+			memset(fixed + 144, 9, 112);
+			memset(fixed + 256, 7, 24);
+			memset(fixed + 280, 8, 8);
+			memset(fixed + 288, 5, 32);
+			Current = Step::Codes;
+			return Lengths.Build(fixed, 288) && Distances.Build(fixed + 288, 32);
+		}
+		if (type != 2)
+			return false;
+
+		static const uint8_t order[19] = { 16, 17, 18, 0, 8, 7, 9, 6, 10, 5, 11, 4, 12, 3, 13, 2, 14, 1, 15 };
+		int literalCount = GetBits(5) + 257;
+		int distanceCount = GetBits(5) + 1;
+		int codeLengthCount = GetBits(4) + 4;
+
+		uint8_t codeLengths[19] = {};
+		for (int i = 0; i < codeLengthCount; i++)
+			codeLengths[order[i]] = (uint8_t)GetBits(3);
+		Huffman codeLengthHuffman;
+		if (!codeLengthHuffman.Build(codeLengths, 19))
+			return false;
+
+		uint8_t all[288 + 32];
+		int count = 0;
+		while (count < literalCount + distanceCount)
+		{
+			int symbol = Decode(codeLengthHuffman);
+			if (symbol < 0)
+				return false;
+			if (symbol < 16)
+			{
+				all[count++] = (uint8_t)symbol;
+				continue;
+			}
+
+			int repeat;
+			uint8_t value = 0;
+			if (symbol == 16)
+			{
+				if (count == 0)
+					return false;
+				value = all[count - 1];
+				repeat = 3 + GetBits(2);
+			}
+			else if (symbol == 17)
+				repeat = 3 + GetBits(3);
+			else
+				repeat = 11 + GetBits(7);
+
+			if (count + repeat > literalCount + distanceCount)
+				return false;
+			memset(all + count, value, repeat);
+			count += repeat;
+		}
+
+		Current = Step::Codes;
+		return Lengths.Build(all, literalCount) && Distances.Build(all + literalCount, distanceCount);
+	}
+
+	//Inflates until the stream ends or Out is full
+	Result Inflate()
+	{
+		while (true)
+		{
+			switch (Current)
+			{
+				case Step::Finished:
+					return Result::Done;
+				case Step::BlockHeader:
+					if (LastBlock)
+					{
+						Current = Step::Finished;
+						return Result::Done;
+					}
+					if (!BlockHeader())
+						return Result::Error;
+					break;
+				case Step::Stored:
+					if (!Stored())
+						return Result::Error;
+					if (Remaining > 0)
+						return Result::OutputFull;
+					Current = Step::BlockHeader;
+					break;
+				case Step::Codes:
+				{
+					Result result = Codes();
+					if (result != Result::Done)
+						return result;
+					Current = Step::BlockHeader;
+					break;
+				}
+			}
+		}
+	}
+};
+
+//Unfiltering, bpp is the distance in bytes to the pixel on the left
+
+inline uint8_t Paeth(int a, int b, int c)
+{
+	int p = a + b - c;
+	int pa = std::abs(p - a), pb = std::abs(p - b), pc = std::abs(p - c);
+	if (pa <= pb && pa <= pc)
+		return (uint8_t)a;
+	return (uint8_t)(pb <= pc ? b : c);
+}
+
+#ifdef PNGDECODER_SSE2
+
+inline __m128i Load4(const uint8_t* p)
+{
+	int value;
+	memcpy(&value, p, 4);
+	return _mm_cvtsi32_si128(value);
+}
+
+inline void Store4(uint8_t* p, __m128i value)
+{
+	int result = _mm_cvtsi128_si32(value);
+	memcpy(p, &result, 4);
+}
+
+//One RGBA pixel per step, the left neighbour has to be finished before the next pixel can start so
+//the work is spread across the four channels instead
+bool UnfilterRow4(int filter, uint8_t* row, const uint8_t* previous, size_t size)
+{
+	const __m128i zero = _mm_setzero_si128();
+	__m128i left = zero, upLeft = zero;
+	switch (filter)
+	{
+		case 1:
+			for (size_t i = 0; i < size; i += 4)
+			{
+				left = _mm_add_epi8(left, Load4(row + i));
+				Store4(row + i, left);
+			}
+			return true;
+		case 3:
+			for (size_t i = 0; i < size; i += 4)
+			{
+				__m128i up = _mm_unpacklo_epi8(Load4(previous + i), zero);
+				__m128i average = _mm_srli_epi16(_mm_add_epi16(_mm_unpacklo_epi8(left, zero), up), 1);
+				left = _mm_add_epi8(Load4(row + i), _mm_packus_epi16(average, average));
+				Store4(row + i, left);
+			}
+			return true;
+		case 4:
+			for (size_t i = 0; i < size; i += 4)
+			{
+				__m128i a = _mm_unpacklo_epi8(left, zero);
+				__m128i b = _mm_unpacklo_epi8(Load4(previous + i), zero);
+				__m128i c = upLeft;
+
+				//pa = |b - c|, pb = |a - c|, pc = |a + b - 2c|
+				__m128i pa = _mm_sub_epi16(b, c), pb = _mm_sub_epi16(a, c);
+				__m128i pc = _mm_add_epi16(pa, pb);
+				pa = _mm_max_epi16(pa, _mm_sub_epi16(zero, pa));
+				pb = _mm_max_epi16(pb, _mm_sub_epi16(zero, pb));
+				pc = _mm_max_epi16(pc, _mm_sub_epi16(zero, pc));
+
+				__m128i useA = _mm_and_si128(_mm_cmpgt_epi16(pb, _mm_sub_epi16(pa, _mm_set1_epi16(1))), _mm_cmpgt_epi16(pc, _mm_sub_epi16(pa, _mm_set1_epi16(1))));
+				__m128i useB = _mm_andnot_si128(useA, _mm_cmpgt_epi16(pc, _mm_sub_epi16(pb, _mm_set1_epi16(1))));
+				__m128i useC = _mm_andnot_si128(_mm_or_si128(useA, useB), _mm_set1_epi16(-1));
+				__m128i predictor = _mm_or_si128(_mm_or_si128(_mm_and_si128(useA, a), _mm_and_si128(useB, b)), _mm_and_si128(useC, c));
+
+				left = _mm_add_epi8(Load4(row + i), _mm_packus_epi16(predictor, predictor));
+				Store4(row + i, left);
+				upLeft = b;
+			}
+			return true;
+	}
+	return false;
+}
+
+#endif
+
+bool UnfilterRow(int filter, uint8_t* row, const uint8_t* previous, size_t size, int bpp)
+{
+	switch (filter)
+	{
+		case 0:
+			return true;
+		case 2:
+		{
+			size_t i = 0;
+#ifdef PNGDECODER_SSE2
+			for (; i + 16 <= size; i += 16)
+				_mm_storeu_si128((__m128i*)(row + i), _mm_add_epi8(_mm_loadu_si128((const __m128i*)(row + i)), _mm_loadu_si128((const __m128i*)(previous + i))));
+#endif
+			for (; i < size; i++)
+				row[i] += previous[i];
+			return true;
+		}
+	}
+
+#ifdef PNGDECODER_SSE2
+	if (bpp == 4)
+		return UnfilterRow4(filter, row, previous, size);
+#endif
+
+	switch (filter)
+	{
+		case 1:
+			for (size_t i = bpp; i < size; i++)
+				row[i] += row[i - bpp];
+			return true;
+		case 3:
+			for (int i = 0; i < bpp; i++)
+				row[i] += previous[i] >> 1;
+			for (size_t i = bpp; i < size; i++)
+				row[i] += (uint8_t)((row[i - bpp] + previous[i]) >> 1);
+			return true;
+		case 4:
+			for (int i = 0; i < bpp; i++)
+				row[i] += previous[i];
+			for (size_t i = bpp; i < size; i++)
+				row[i] += Paeth(row[i - bpp], previous[i], previous[i - bpp]);
+			return true;
+	}
+	return false;
+}
+
+//Conversion to 8 bit samples of the requested channel count
+
+struct Format
+{
+	int Width, BitDepth, ColourType;
+	int FileChannels; //What the source expands to, including alpha from tRNS
+	const uint8_t* Palette; //RGBA, 256 entries
+	bool HasKey;
+	uint16_t Key[3];
+};
+
+//Writes the row as FileChannels 8 bit samples
+void ExpandRow(const Format& format, const uint8_t* row, uint8_t* out)
+{
+	const int width = format.Width;
+	if (format.ColourType == 3)
+	{
+		const int depth = format.BitDepth, mask = (1 << depth) - 1;
+		for (int x = 0; x < width; x++)
+		{
+			int index = depth == 8 ? row[x] : (row[(x * depth) >> 3] >> (8 - depth - ((x * depth) & 7))) & mask;
+			memcpy(out + x * format.FileChannels, format.Palette + index * 4, format.FileChannels);
+		}
+		return;
+	}
+
+	const int samples = format.ColourType == 0 ? 1 : format.ColourType == 2 ? 3 : format.ColourType == 4 ? 2 : 4;
+	if (format.BitDepth < 8)
+	{
+		//Only grey can be below 8 bits, scaled so the largest value is 255
+		const int depth = format.BitDepth, mask = (1 << depth) - 1, scale = 255 / mask;
+		for (int x = 0; x < width; x++)
+		{
+			int value = (row[(x * depth) >> 3] >> (8 - depth - ((x * depth) & 7))) & mask;
+			out[x * format.FileChannels] = (uint8_t)(value * scale);
+			if (format.HasKey)
+				out[x * format.FileChannels + 1] = value == format.Key[0] ? 0 : 255;
+		}
+		return;
+	}
+
+	const int step = format.BitDepth / 8;
+	if (!format.HasKey && step == 1)
+	{
+		memcpy(out, row, (size_t)width * samples);
+		return;
+	}
+
+	for (int x = 0; x < width; x++)
+	{
+		const uint8_t* in = row + (size_t)x * samples * step;
+		uint8_t* pixel = out + (size_t)x * format.FileChannels;
+		bool matchesKey = format.HasKey;
+		for (int s = 0; s < samples; s++)
+		{
+			//16 bit samples keep their high byte, the key is compared at full precision
+			uint16_t value = step == 2 ? (uint16_t)((in[s * 2] << 8) | in[s * 2 + 1]) : in[s];
+			pixel[s] = in[s * step];
+			if (format.HasKey && value != format.Key[s])
+				matchesKey = false;
+		}
+		if (format.HasKey)
+			pixel[samples] = matchesKey ? 0 : 255;
+	}
+}
+
+void ConvertRow(const uint8_t* in, int inChannels, uint8_t* out, int outChannels, int width)
+{
+	if (inChannels == outChannels)
+	{
+		memcpy(out, in, (size_t)width * inChannels);
+		return;
+	}
+
+	for (int x = 0; x < width; x++, in += inChannels, out += outChannels)
+	{
+		const bool inGrey = inChannels < 3;
+		const uint8_t alpha = (inChannels == 2 || inChannels == 4) ? in[inChannels - 1] : 255;
+		if (outChannels < 3)
+		{
+			//Same weights as stb_image
+			out[0] = inGrey ? in[0] : (uint8_t)((in[0] * 77 + in[1] * 150 + in[2] * 29) >> 8);
+			if (outChannels == 2)
+				out[1] = alpha;
+		}
+		else
+		{
+			out[0] = in[0];
+			out[1] = inGrey ? in[0] : in[1];
+			out[2] = inGrey ? in[0] : in[2];
+			if (outChannels == 4)
+				out[3] = alpha;
+		}
+	}
+}
+
+}
+
+bool IsPng(const unsigned char* data, size_t size)
+{
+	static const uint8_t signature[8] = { 137, 80, 78, 71, 13, 10, 26, 10 };
+	return size >= 8 && memcmp(data, signature, 8) == 0;
+}
+
+namespace {
+
+//What the chunks before the image data say about the image, Info.Palette points into this so it is used in place
+struct PngHeader
+{
+	Format Info;
+	uint8_t Palette[256 * 4];
+	int Height, Samples, BytesPerPixel;
+	size_t Stride; //Bytes in a row, not counting the filter byte
+	size_t FirstChunk; //Where the first IDAT chunk starts
+};
+
+bool ReadHeader(const uint8_t* data, size_t size, PngHeader& header, const char** error)
+{
+	auto fail = [error](const char* reason)
+	{
+		if (error)
+			*error = reason;
+		return false;
+	};
+
+	if (!IsPng(data, size))
+		return fail("not a PNG");
+
+	Format& format = header.Info;
+	format = {};
+	header.Height = 0;
+	header.FirstChunk = 0;
+	int paletteSize = 0;
+	bool hasPaletteAlpha = false;
+	int interlace = 0;
+
+	//CRCs aren't checked, a corrupt stream is still caught by inflate or the size checks. PLTE and tRNS have
+	//to come before the image data so the walk stops at the first IDAT
+	size_t position = 8;
+	bool seenHeader = false;
+	while (position + 12 <= size)
+	{
+		const uint32_t length = ReadBigEndian(data + position);
+		const uint8_t* type = data + position + 4;
+		const uint8_t* chunk = data + position + 8;
+		if (length > size - position - 12)
+			return fail("truncated chunk");
+
+		if (memcmp(type, "IDAT", 4) == 0)
+		{
+			header.FirstChunk = position;
+			break;
+		}
+		position += 12 + (size_t)length;
+
+		if (memcmp(type, "IHDR", 4) == 0)
+		{
+			if (length != 13)
+				return fail("bad IHDR");
+			format.Width = (int)ReadBigEndian(chunk);
+			header.Height = (int)ReadBigEndian(chunk + 4);
+			format.BitDepth = chunk[8];
+			format.ColourType = chunk[9];
+			interlace = chunk[12];
+			seenHeader = true;
+		}
+		else if (memcmp(type, "PLTE", 4) == 0)
+		{
+			paletteSize = std::min<int>(256, length / 3);
+			for (int i = 0; i < paletteSize; i++)
+			{
+				memcpy(header.Palette + i * 4, chunk + i * 3, 3);
+				header.Palette[i * 4 + 3] = 255;
+			}
+		}
+		else if (memcmp(type, "tRNS", 4) == 0)
+		{
+			if (format.ColourType == 3)
+			{
+				for (uint32_t i = 0; i < length && i < 256; i++)
+					header.Palette[i * 4 + 3] = chunk[i];
+				hasPaletteAlpha = true;
+			}
+			else if (format.ColourType == 0 && length >= 2)
+			{
+				format.HasKey = true;
+				format.Key[0] = (uint16_t)((chunk[0] << 8) | chunk[1]);
+			}
+			else if (format.ColourType == 2 && length >= 6)
+			{
+				format.HasKey = true;
+				for (int i = 0; i < 3; i++)
+					format.Key[i] = (uint16_t)((chunk[i * 2] << 8) | chunk[i * 2 + 1]);
+			}
+		}
+		else if (memcmp(type, "IEND", 4) == 0)
+			break;
+	}
+
+	if (!seenHeader || format.Width <= 0 || header.Height <= 0 || format.Width > (1 << 24) || header.Height > (1 << 24))
+		return fail("bad image size");
+	if (interlace != 0)
+		return fail("interlaced PNGs aren't supported");
+	if (header.FirstChunk == 0)
+		return fail("missing image data");
+
+	switch (format.ColourType)
+	{
+		case 0: header.Samples = 1; break;
+		case 2: header.Samples = 3; break;
+		case 3: header.Samples = 1; break;
+		case 4: header.Samples = 2; break;
+		case 6: header.Samples = 4; break;
+		default: return fail("bad colour type");
+	}
+	const int depth = format.BitDepth;
+	if (!(depth == 8 || depth == 16 || ((format.ColourType == 0 || format.ColourType == 3) && (depth == 1 || depth == 2 || depth == 4))) ||
+		(format.ColourType == 3 && depth == 16))
+		return fail("unsupported bit depth");
+	if (format.ColourType == 3 && paletteSize == 0)
+		return fail("missing palette");
+
+	format.Palette = header.Palette;
+	if (format.ColourType == 3)
+		format.FileChannels = hasPaletteAlpha ? 4 : 3;
+	else
+		format.FileChannels = header.Samples + (format.HasKey ? 1 : 0);
+
+	header.Stride = ((size_t)format.Width * header.Samples * depth + 7) / 8;
+	header.BytesPerPixel = std::max(1, header.Samples * depth / 8);
+	return true;
+}
+
+}
+
+unsigned char* DecodePng(const unsigned char* data, size_t size, int* width, int* height, int* channels, int desiredChannels, bool flip, const char** error)
+{
+	auto fail = [error](const char* reason) -> unsigned char*
+	{
+		if (error)
+			*error = reason;
+		return nullptr;
+	};
+
+	PngHeader header;
+	if (!ReadHeader(data, size, header, error))
+		return nullptr;
+	const Format& format = header.Info;
+
+	//The size comes from the file, so a bad or huge header fails here rather than throwing
+	const size_t stride = header.Stride;
+	const size_t rawSize = (stride + 1) * header.Height;
+	std::unique_ptr<uint8_t[]> raw(new (std::nothrow) uint8_t[rawSize + 8]);
+	if (!raw)
+		return fail("out of memory");
+
+	Inflater inflater(data, size, header.FirstChunk, raw.get(), rawSize);
+	if (!inflater.Begin())
+		return fail("bad zlib header");
+	if (inflater.Inflate() == Inflater::Result::Error || inflater.OutPosition != rawSize)
+		return fail("corrupt image data");
+
+	const int outChannels = desiredChannels != 0 ? desiredChannels : format.FileChannels;
+	unsigned char* pixels = (unsigned char*)malloc((size_t)format.Width * header.Height * outChannels);
+	if (!pixels)
+		return fail("out of memory");
+
+	std::vector<uint8_t> zeroRow(stride, 0);
+	std::vector<uint8_t> expanded((size_t)format.Width * format.FileChannels);
+	const uint8_t* previous = zeroRow.data();
+	for (int y = 0; y < header.Height; y++)
+	{
+		uint8_t* row = raw.get() + y * (stride + 1);
+		if (!UnfilterRow(row[0], row + 1, previous, stride, header.BytesPerPixel))
+		{
+			free(pixels);
+			return fail("bad filter type");
+		}
+		previous = row + 1;
+
+		//Rows go straight to where they belong in the flipped image
+		unsigned char* destination = pixels + (size_t)(flip ? header.Height - 1 - y : y) * format.Width * outChannels;
+		ExpandRow(format, row + 1, expanded.data());
+		ConvertRow(expanded.data(), format.FileChannels, destination, outChannels, format.Width);
+	}
+
+	*width = format.Width;
+	*height = header.Height;
+	if (channels)
+		*channels = format.FileChannels;
+	return pixels;
+}
+
+bool GetPngInfo(const unsigned char* data, size_t size, int* width, int* height, int* channels, const char** error)
+{
+	PngHeader header;
+	if (!ReadHeader(data, size, header, error))
+		return false;
+	*width = header.Info.Width;
+	*height = header.Height;
+	if (channels)
+		*channels = header.Info.FileChannels;
+	return true;
+}
+
+bool DecodePngRows(const unsigned char* data, size_t size, int desiredChannels, const std::function<void(int y, const unsigned char* row)>& onRow, const char** error)
+{
+	auto fail = [error](const char* reason)
+	{
+		if (error)
+			*error = reason;
+		return false;
+	};
+
+	PngHeader header;
+	if (!ReadHeader(data, size, header, error))
+		return false;
+	const Format& format = header.Info;
+
+	//Back references reach up to 32KB behind, so that much output is kept when the buffer slides along and the
+	//rest of it is room for new rows
+	const size_t window = 32768;
+	const size_t rowSize = header.Stride + 1;
+	const size_t capacity = window + std::max<size_t>(rowSize * 4, 1 << 16);
+	std::unique_ptr<uint8_t[]> buffer(new (std::nothrow) uint8_t[capacity + 8]);
+	if (!buffer)
+		return fail("out of memory");
+
+	const int outChannels = desiredChannels != 0 ? desiredChannels : format.FileChannels;
+	std::vector<uint8_t> previous(rowSize, 0), current(rowSize);
+	std::vector<uint8_t> expanded((size_t)format.Width * format.FileChannels);
+	std::vector<uint8_t> converted((size_t)format.Width * outChannels);
+
+	Inflater inflater(data, size, header.FirstChunk, buffer.get(), capacity);
+	if (!inflater.Begin())
+		return fail("bad zlib header");
+
+	Inflater::Result result = Inflater::Result::OutputFull;
+	size_t rowStart = 0;
+	for (int y = 0; y < header.Height; y++)
+	{
+		while (inflater.OutPosition - rowStart < rowSize)
+		{
+			if (result == Inflater::Result::Done)
+				return fail("corrupt image data");
+
+			const size_t keep = std::min(rowStart, inflater.OutPosition - std::min(inflater.OutPosition, window));
+			memmove(buffer.get(), buffer.get() + keep, inflater.OutPosition - keep);
+			inflater.OutPosition -= keep;
+			rowStart -= keep;
+
+			result = inflater.Inflate();
+			if (result == Inflater::Result::Error)
+				return fail("corrupt image data");
+		}
+
+		//Unfiltered in a copy, the inflater still needs the filtered bytes for back references
+		memcpy(current.data(), buffer.get() + rowStart, rowSize);
+		rowStart += rowSize;
+		if (!UnfilterRow(current[0], current.data() + 1, previous.data() + 1, header.Stride, header.BytesPerPixel))
+			return fail("bad filter type");
+		ExpandRow(format, current.data() + 1, expanded.data());
+		ConvertRow(expanded.data(), format.FileChannels, converted.data(), outChannels, format.Width);
+		onRow(y, converted.data());
+		std::swap(previous, current);
+	}
+	return true;
+}
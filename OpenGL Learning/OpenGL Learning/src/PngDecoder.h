@@ -0,0 +1,21 @@
+#pragma once
+
+#include <cstddef>
+#include <functional>
+
+//A PNG decoder built for load times rather than coverage. Inflate decodes from a 64 bit bit buffer with table
+//lookups, rows are unfiltered with SSE2 where it helps and each row is converted and written straight to its
+//final, optionally flipped, position so there is no separate flip pass. Interlaced images aren't supported and
+//return null so the caller can fall back to stb_image.
+//The result is allocated with malloc, channels is what the file holds and desiredChannels 0 keeps that.
+unsigned char* DecodePng(const unsigned char* data, size_t size, int* width, int* height, int* channels, int desiredChannels, bool flip, const char** error);
+
+//Reads the size and channel count from the header without decoding anything
+bool GetPngInfo(const unsigned char* data, size_t size, int* width, int* height, int* channels, const char** error);
+
+//Decodes a row at a time, top row first, handing each to onRow, for images too big to hold in memory at once.
+//Only the inflate window and a couple of rows are kept, the row passed to onRow is only valid during the call.
+bool DecodePngRows(const unsigned char* data, size_t size, int desiredChannels, const std::function<void(int y, const unsigned char* row)>& onRow, const char** error);
+
+//True if the data starts with the PNG signature
+bool IsPng(const unsigned char* data, size_t size);
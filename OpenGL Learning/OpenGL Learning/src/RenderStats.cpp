@@ -0,0 +1,10 @@
+#include "RenderStats.h"
+
+RenderStats RenderStats::s_Current;
+RenderStats RenderStats::s_LastFrame;
+
+void RenderStats::EndFrame()
+{
+	s_LastFrame = s_Current;
+	s_Current = RenderStats();
+}
@@ -0,0 +1,25 @@
+#pragma once
+
+//What the renderer asked GL to do in a frame. The classes that make the calls add to Current() as they go and
+//EndFrame keeps the totals as the last frame's, so a regression can be put down to more draws, more state
+//changes or more uploads. Only the GL thread touches these. ImGui draws through its own backend and isn't counted.
+struct RenderStats
+{
+	unsigned int DrawCalls = 0;
+	unsigned long long Triangles = 0;
+	unsigned int ProgramBinds = 0;
+	unsigned int VertexArrayBinds = 0;
+	unsigned int TextureBinds = 0;
+	unsigned int UniformUploads = 0;
+	unsigned long long BufferBytesUploaded = 0; //Vertex and index data
+	unsigned long long TextureBytesUploaded = 0; //Texels, whether they come from memory or a pixel buffer
+	unsigned int BuffersCreated = 0;
+	unsigned int TexturesCreated = 0;
+
+	static inline RenderStats& Current() { return s_Current; }
+	static inline const RenderStats& GetLastFrame() { return s_LastFrame; }
+	static void EndFrame();
+
+private:
+	static RenderStats s_Current, s_LastFrame;
+};
@@ -0,0 +1,63 @@
+#include "RenderTargetPool.h"
+
+#include <algorithm>
+
+RenderTargetPool::RenderTargetPool(unsigned int maxIdleFrames)
+	: m_Frame(0), m_MaxIdleFrames(maxIdleFrames)
+{
+}
+
+Framebuffer& RenderTargetPool::Acquire(int width, int height, unsigned int colourFormat, bool depth)
+{
+	for (Target& target : m_Targets)
+	{
+		const Framebuffer& framebuffer = *target.Buffer;
+		if (!target.InUse && framebuffer.GetWidth() == width && framebuffer.GetHeight() == height &&
+			framebuffer.GetColourFormat() == colourFormat && framebuffer.HasDepth() == depth)
+		{
+			target.InUse = true;
+			target.LastUsedFrame = m_Frame;
+			return *target.Buffer;
+		}
+	}
+
+	m_Targets.push_back({ std::make_unique<Framebuffer>(width, height, depth, colourFormat), true, m_Frame });
+	return *m_Targets.back().Buffer;
+}
+
+void RenderTargetPool::Release(const Framebuffer& framebuffer)
+{
+	for (Target& target : m_Targets)
+	{
+		if (target.Buffer.get() == &framebuffer)
+		{
+			target.InUse = false;
+			return;
+		}
+	}
+}
+
+void RenderTargetPool::Update()
+{
+	m_Frame++;
+	for (Target& target : m_Targets)
+		target.InUse = false;
+
+	m_Targets.erase(std::remove_if(m_Targets.begin(), m_Targets.end(), [this](const Target& target)
+	{
+		return m_Frame - target.LastUsedFrame > m_MaxIdleFrames;
+	}), m_Targets.end());
+}
+
+void RenderTargetPool::Purge()
+{
+	m_Targets.erase(std::remove_if(m_Targets.begin(), m_Targets.end(), [](const Target& target) { return !target.InUse; }), m_Targets.end());
+}
+
+size_t RenderTargetPool::GetMemoryUsage() const
+{
+	size_t size = 0;
+	for (const Target& target : m_Targets)
+		size += target.Buffer->GetMemoryUsage();
+	return size;
+}
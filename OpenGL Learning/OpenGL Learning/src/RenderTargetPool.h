@@ -0,0 +1,39 @@
+#pragma once
+
+#include <memory>
+#include <vector>
+
+#include "Framebuffer.h"
+
+//Hands out framebuffers for passes that only need them for part of a frame, such as post effects, and
+//recycles them instead of allocating new ones. A target is reused by any request with the same size, format
+//and depth. Everything acquired is handed back by Update at the end of the frame, or earlier with Release so
+//a later pass in the same frame can reuse it. Targets nobody has asked for in a while are deleted.
+class RenderTargetPool
+{
+private:
+	struct Target
+	{
+		std::unique_ptr<Framebuffer> Buffer;
+		bool InUse;
+		unsigned int LastUsedFrame;
+	};
+
+	std::vector<Target> m_Targets;
+	unsigned int m_Frame;
+	unsigned int m_MaxIdleFrames;
+
+public:
+	RenderTargetPool(unsigned int maxIdleFrames = 60);
+
+	Framebuffer& Acquire(int width, int height, unsigned int colourFormat = GL_RGBA8, bool depth = false);
+	void Release(const Framebuffer& framebuffer);
+
+	//Releases everything acquired this frame and deletes targets that have been idle for too long
+	void Update();
+	//Deletes every target that isn't in use, e.g. after the window has been resized
+	void Purge();
+
+	inline unsigned int GetTargetCount() const { return (unsigned int)m_Targets.size(); }
+	size_t GetMemoryUsage() const;
+};
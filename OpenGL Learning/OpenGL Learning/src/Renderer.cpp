@@ -1,18 +1,25 @@
 #include "Renderer.h"
-#include <iostream>
+#include "CpuProfiler.h"
+#include "GLDebugOutput.h"
+#include "RenderStats.h"
+#include "Log.h"
 
+//Both do nothing while the driver reports errors through GLDebugOutput instead
 void GLClearError()
 {
+	if (GLDebugOutput::IsReportingErrors())
+		return;
 	while(glGetError() != GL_NO_ERROR);
 }
 bool GLLogCall(const char* function, const char* file, int line)
 {
+	if (GLDebugOutput::IsReportingErrors())
+		return true;
 	while(GLenum error = glGetError())
 	{
-		std::cout << "[OpenGL Error]"
-				  << "\n("<< error <<")\n"
-				  << function << " " << file << ":" << line
-				  <<  std::endl;
+		Log::Error("[OpenGL Error]\n({})\n{} {}:{}", error, function, file, line);
+		//The caller breaks next, so the message has to be out first
+		Log::Flush();
 		
 		return false;
 	}
@@ -24,12 +31,57 @@ void Renderer::Clear() const
 	GLCall(glClear(GL_COLOR_BUFFER_BIT));
 }
 
+void Renderer::SetBlendMode(BlendMode mode) const
+{
+	if (mode == BlendMode::None)
+	{
+		GLCall(glDisable(GL_BLEND));
+		return;
+	}
+
+	GLCall(glEnable(GL_BLEND));
+	switch (mode)
+	{
+		case BlendMode::Alpha: GLCall(glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA)); break;
+		case BlendMode::Premultiplied: GLCall(glBlendFunc(GL_ONE, GL_ONE_MINUS_SRC_ALPHA)); break;
+		case BlendMode::Additive: GLCall(glBlendFunc(GL_ONE, GL_ONE)); break;
+		default: break;
+	}
+}
+
 void Renderer::Draw(const VertexArray& va, const IndexBuffer& ib, const Shader& shader) const
 {
+	PROFILE_SCOPE("Draw");
 	shader.Bind();			
 	va.Bind();
 	ib.Bind();
+	RenderStats::Current().DrawCalls++;
+	RenderStats::Current().Triangles += ib.GetCount() / 3;
 
 	GLCall(glDrawElements(GL_TRIANGLES, ib.GetCount(), GL_UNSIGNED_INT, nullptr));	
 
+}
+
+void Renderer::Draw(const VertexArray& va, const IndexBuffer& ib, const Shader& shader, unsigned int indexCount) const
+{
+	PROFILE_SCOPE("Draw");
+	shader.Bind();
+	va.Bind();
+	ib.Bind();
+	RenderStats::Current().DrawCalls++;
+	RenderStats::Current().Triangles += indexCount / 3;
+
+	GLCall(glDrawElements(GL_TRIANGLES, indexCount, GL_UNSIGNED_INT, nullptr));
+}
+
+void Renderer::DrawInstanced(const VertexArray& va, const IndexBuffer& ib, const Shader& shader, unsigned int instanceCount) const
+{
+	PROFILE_SCOPE("DrawInstanced");
+	shader.Bind();
+	va.Bind();
+	ib.Bind();
+	RenderStats::Current().DrawCalls++;
+	RenderStats::Current().Triangles += (unsigned long long)(ib.GetCount() / 3) * instanceCount;
+
+	GLCall(glDrawElementsInstanced(GL_TRIANGLES, ib.GetCount(), GL_UNSIGNED_INT, nullptr, instanceCount));
 }
\ No newline at end of file
@@ -1,9 +1,53 @@
 #pragma once
 
-#define ASSERT(x) if (!(x)) __debugbreak();
+#if defined(_MSC_VER)
+#define DEBUG_BREAK() __debugbreak()
+#elif defined(__GNUC__) || defined(__clang__)
+#include <csignal>
+#define DEBUG_BREAK() std::raise(SIGTRAP)
+#else
+#include <cstdlib>
+#define DEBUG_BREAK() std::abort()
+#endif
+
+#define ASSERT(x) do { if (!(x)) DEBUG_BREAK(); } while (0)
+
+//How much GLCall checks for errors, set GL_CHECK_POLICY to one of these to override the default. glGetError makes
+//many drivers synchronise with the GPU, so it can cost far more than the call it is checking
+#define GL_CHECK_OFF 0 //GLCall is just the call, the default for release builds
+#define GL_CHECK_SAMPLED 1 //Each GLCall checks one call in GL_CHECK_SAMPLE_RATE, persistent errors still show up
+#define GL_CHECK_FULL 2 //Every call is checked and breaks on an error, the default for debug builds
+
+#ifndef GL_CHECK_POLICY
+#if defined(_DEBUG) || (!defined(_MSC_VER) && !defined(NDEBUG))
+#define GL_CHECK_POLICY GL_CHECK_FULL
+#else
+#define GL_CHECK_POLICY GL_CHECK_OFF
+#endif
+#endif
+
+#ifndef GL_CHECK_SAMPLE_RATE
+#define GL_CHECK_SAMPLE_RATE 64
+#endif
+
+#define GL_CHECK_CONCAT_INNER(a, b) a##b
+#define GL_CHECK_CONCAT(a, b) GL_CHECK_CONCAT_INNER(a, b)
+
+//GLCall expands to plain statements rather than a block so it can wrap declarations, which also means it has to
+//be braced when it is the body of an if or a loop
+#if GL_CHECK_POLICY == GL_CHECK_FULL
 #define GLCall(x) GLClearError();\
 		x;\
 		ASSERT(GLLogCall(#x, __FILE__, __LINE__))
+#elif GL_CHECK_POLICY == GL_CHECK_SAMPLED
+//The counter is static so it can be jumped over by a case label, GL is only called from one thread
+#define GLCall(x) static unsigned int GL_CHECK_CONCAT(s_GLCallCount, __LINE__) = 0;\
+		if (GL_CHECK_CONCAT(s_GLCallCount, __LINE__) % GL_CHECK_SAMPLE_RATE == 0) GLClearError();\
+		x;\
+		if (GL_CHECK_CONCAT(s_GLCallCount, __LINE__)++ % GL_CHECK_SAMPLE_RATE == 0) ASSERT(GLLogCall(#x, __FILE__, __LINE__))
+#else
+#define GLCall(x) x
+#endif
 
 void GLClearError();
 bool GLLogCall(const char* function, const char* file, int line);
@@ -13,9 +57,23 @@ bool GLLogCall(const char* function, const char* file, int line);
 #include "IndexBuffer.h"
 #include "shader.h"
 
+enum class BlendMode
+{
+	None,
+	Alpha, //GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA for straight alpha textures
+	//GL_ONE, GL_ONE_MINUS_SRC_ALPHA for textures loaded with TextureOptions::Premultiply. Additive sprites can go
+	//in the same batch as blended ones by writing their colour with an alpha of 0
+	Premultiplied,
+	Additive //GL_ONE, GL_ONE
+};
+
 class Renderer
 {
 public:
 	void Clear() const;
+	void SetBlendMode(BlendMode mode) const;
 	void Draw(const VertexArray& va, const IndexBuffer& ib, const Shader& shader) const;
+	//Only draws the first indexCount indices, for buffers sized for the worst case
+	void Draw(const VertexArray& va, const IndexBuffer& ib, const Shader& shader, unsigned int indexCount) const;
+	void DrawInstanced(const VertexArray& va, const IndexBuffer& ib, const Shader& shader, unsigned int instanceCount) const;
 };
\ No newline at end of file
@@ -0,0 +1,98 @@
+#include "Sampler.h"
+
+#include <algorithm>
+#include <functional>
+#include <unordered_map>
+
+namespace {
+
+struct SamplerStateHash
+{
+	size_t operator()(const SamplerState& state) const
+	{
+		size_t hash = std::hash<float>()(state.Anisotropy);
+		for (unsigned int value : { state.MinFilter, state.MagFilter, state.WrapS, state.WrapT })
+			hash = hash * 31 + value;
+		return hash;
+	}
+};
+
+//Only weak references so the samplers are deleted with the last texture using them, while the context is still alive
+std::unordered_map<SamplerState, std::weak_ptr<Sampler>, SamplerStateHash> s_Samplers;
+SamplerQuality s_Quality = SamplerQuality::Full;
+
+}
+
+std::shared_ptr<Sampler> Sampler::Get(const SamplerState& state)
+{
+	std::weak_ptr<Sampler>& cached = s_Samplers[state];
+	std::shared_ptr<Sampler> sampler = cached.lock();
+	if (!sampler)
+	{
+		sampler = std::make_shared<Sampler>(state);
+		cached = sampler;
+	}
+	return sampler;
+}
+
+void Sampler::SetQuality(SamplerQuality quality)
+{
+	s_Quality = quality;
+	for (auto it = s_Samplers.begin(); it != s_Samplers.end();)
+	{
+		if (std::shared_ptr<Sampler> sampler = it->second.lock())
+		{
+			sampler->Apply();
+			++it;
+		}
+		else
+			it = s_Samplers.erase(it);
+	}
+}
+
+SamplerQuality Sampler::GetQuality()
+{
+	return s_Quality;
+}
+
+Sampler::Sampler(const SamplerState& state)
+	: m_RendererID(0), m_State(state)
+{
+	GLCall(glGenSamplers(1, &m_RendererID));
+	Apply();
+}
+
+Sampler::~Sampler()
+{
+	GLCall(glDeleteSamplers(1, &m_RendererID));
+}
+
+void Sampler::Apply()
+{
+	unsigned int minFilter = m_State.MinFilter;
+	if (s_Quality == SamplerQuality::Bilinear && minFilter == GL_LINEAR_MIPMAP_LINEAR)
+		minFilter = GL_LINEAR_MIPMAP_NEAREST;
+
+	GLCall(glSamplerParameteri(m_RendererID, GL_TEXTURE_MIN_FILTER, minFilter));
+	GLCall(glSamplerParameteri(m_RendererID, GL_TEXTURE_MAG_FILTER, m_State.MagFilter));
+	GLCall(glSamplerParameteri(m_RendererID, GL_TEXTURE_WRAP_S, m_State.WrapS));
+	GLCall(glSamplerParameteri(m_RendererID, GL_TEXTURE_WRAP_T, m_State.WrapT));
+
+	if (GLEW_EXT_texture_filter_anisotropic)
+	{
+		float maxAnisotropy;
+		GLCall(glGetFloatv(GL_MAX_TEXTURE_MAX_ANISOTROPY_EXT, &maxAnisotropy));
+		const float anisotropy = s_Quality == SamplerQuality::Full ? std::min(m_State.Anisotropy, maxAnisotropy) : 1.0f;
+		GLCall(glSamplerParameterf(m_RendererID, GL_TEXTURE_MAX_ANISOTROPY_EXT, std::max(anisotropy, 1.0f)));
+	}
+}
+
+void Sampler::Bind(unsigned int slot) const
+{
+	GLCall(glBindSampler(slot, m_RendererID));
+}
+
+void Sampler::UnBind(unsigned int slot)
+{
+	GLCall(glBindSampler(slot, 0));
+}
@@ -0,0 +1,60 @@
+#pragma once
+
+#include <memory>
+
+#include "Renderer.h"
+
+struct SamplerState
+{
+	unsigned int MinFilter = GL_LINEAR;
+	unsigned int MagFilter = GL_LINEAR;
+	unsigned int WrapS = GL_CLAMP_TO_EDGE;
+	unsigned int WrapT = GL_CLAMP_TO_EDGE;
+	float Anisotropy = 1.0f; //Clamped to what the driver supports, 1 turns it off
+
+	inline bool operator==(const SamplerState& other) const
+	{
+		return MinFilter == other.MinFilter && MagFilter == other.MagFilter && WrapS == other.WrapS && WrapT == other.WrapT && Anisotropy == other.Anisotropy;
+	}
+};
+
+//Caps applied to every sampler at once, so filtering can be turned down at runtime without touching any texture
+enum class SamplerQuality
+{
+	Bilinear, //Mip levels are snapped to instead of blended, no anisotropy
+	Trilinear, //No anisotropy
+	Full //Whatever each sampler asked for
+};
+
+//How a texture is filtered and wrapped, kept apart from the texture itself with a sampler object so the same
+//texture can be sampled in different ways and textures never have their parameters changed after creation.
+//Samplers are shared: Get hands out the one sampler for each state for as long as anyone holds it. GL thread only.
+class Sampler
+{
+private:
+	unsigned int m_RendererID;
+	SamplerState m_State;
+
+public:
+	static std::shared_ptr<Sampler> Get(const SamplerState& state);
+
+	//Re-applies every live sampler under the new quality
+	static void SetQuality(SamplerQuality quality);
+	static SamplerQuality GetQuality();
+
+	Sampler(const SamplerState& state);
+	~Sampler();
+
+	Sampler(const Sampler&) = delete;
+	Sampler& operator=(const Sampler&) = delete;
+
+	void Bind(unsigned int slot) const;
+	//Puts the slot back to sampling with the bound texture's own parameters
+	static void UnBind(unsigned int slot);
+
+	inline const SamplerState& GetState() const { return m_State; }
+	inline unsigned int GetRendererID() const { return m_RendererID; }
+
+private:
+	void Apply();
+};
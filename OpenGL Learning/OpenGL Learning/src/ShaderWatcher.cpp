@@ -0,0 +1,274 @@
+#include "ShaderWatcher.h"
+#include "Renderer.h"
+#include "Log.h"
+
+#include <filesystem>
+#include <chrono>
+#include <unordered_map>
+
+#ifdef __linux__
+#include <sys/inotify.h>
+#include <poll.h>
+#include <unistd.h>
+#endif
+
+namespace fs = std::filesystem;
+
+static fs::path NormalisePath(const fs::path& path)
+{
+	return path.lexically_normal();
+}
+
+ShaderWatcher::ShaderWatcher()
+	: m_Running(true), m_ParallelCompile(false)
+{
+	//With parallel compile the driver compiles on its own threads and we can poll for completion instead of blocking
+	if (GLEW_KHR_parallel_shader_compile)
+	{
+		GLCall(glMaxShaderCompilerThreadsKHR(0xFFFFFFFF));
+		m_ParallelCompile = true;
+	}
+	else if (GLEW_ARB_parallel_shader_compile)
+	{
+		GLCall(glMaxShaderCompilerThreadsARB(0xFFFFFFFF));
+		m_ParallelCompile = true;
+	}
+
+	m_Thread = std::thread(&ShaderWatcher::WatchLoop, this);
+}
+
+ShaderWatcher::~ShaderWatcher()
+{
+	m_Running = false;
+	if (m_Thread.joinable())
+		m_Thread.join();
+
+	for (const auto& pending : m_PendingPrograms)
+	{
+		if (pending.Program)
+		{
+			GLCall(glDeleteProgram(pending.Program));
+		}
+	}
+}
+
+void ShaderWatcher::Watch(Shader& shader)
+{
+	std::lock_guard<std::mutex> lock(m_Mutex);
+	m_Shaders.push_back(&shader);
+}
+
+void ShaderWatcher::Update()
+{
+	std::vector<ParsedSource> parsed;
+	{
+		std::lock_guard<std::mutex> lock(m_Mutex);
+		parsed.swap(m_ParsedSources);
+	}
+
+	for (auto& source : parsed)
+	{
+		//A newer edit replaces a compile that is still in flight
+		for (auto it = m_PendingPrograms.begin(); it != m_PendingPrograms.end();)
+		{
+			if (it->Target == source.Target)
+			{
+				if (it->Program)
+				{
+					GLCall(glDeleteProgram(it->Program));
+				}
+				it = m_PendingPrograms.erase(it);
+			}
+			else
+				++it;
+		}
+
+		m_PendingPrograms.push_back({ source.Target, std::move(source.Source), 0, PendingStage::Parsed });
+	}
+
+	if (m_ParallelCompile)
+	{
+		//The driver compiles and links on its own threads, so everything is issued at once and polled
+		for (auto it = m_PendingPrograms.begin(); it != m_PendingPrograms.end();)
+		{
+			if (it->Stage == PendingStage::Parsed)
+			{
+				it->Program = Shader::CreateShader(it->Source);
+				it->Source = {};
+				it->Stage = PendingStage::Linked;
+			}
+
+			int complete = GL_FALSE;
+			GLCall(glGetProgramiv(it->Program, GL_COMPLETION_STATUS_KHR, &complete));
+			if (complete != GL_TRUE)
+			{
+				++it;
+				continue;
+			}
+
+			Finish(*it);
+			it = m_PendingPrograms.erase(it);
+		}
+	}
+	else if (!m_PendingPrograms.empty())
+	{
+		PendingProgram& pending = m_PendingPrograms.front();
+		if (pending.Stage == PendingStage::Linked)
+		{
+			Finish(pending);
+			m_PendingPrograms.erase(m_PendingPrograms.begin());
+		}
+		else
+			Advance(pending);
+	}
+}
+
+//Takes one step of a reload, the next is left for a later frame
+void ShaderWatcher::Advance(PendingProgram& pending)
+{
+	if (pending.Stage == PendingStage::Parsed)
+	{
+		pending.Program = Shader::CompileProgram(pending.Source);
+		pending.Source = {};
+		pending.Stage = PendingStage::Compiled;
+	}
+	else if (pending.Stage == PendingStage::Compiled)
+	{
+		Shader::LinkProgram(pending.Program);
+		pending.Stage = PendingStage::Linked;
+	}
+}
+
+//If the new program is broken the shader keeps running the old one
+void ShaderWatcher::Finish(PendingProgram& pending)
+{
+	if (Shader::CheckProgram(pending.Program))
+	{
+		pending.Target->SwapProgram(pending.Program);
+		Log::Info("Reloaded shader {}", pending.Target->GetFilePath());
+	}
+	else
+	{
+		Log::Warning("Keeping the previous program for {}", pending.Target->GetFilePath());
+		GLCall(glDeleteProgram(pending.Program));
+	}
+}
+
+//Parses the file for every shader that was loaded from it, this runs on the watch thread
+void ShaderWatcher::QueueReload(const std::string& filepath)
+{
+	const fs::path changed = NormalisePath(filepath);
+
+	std::vector<Shader*> targets;
+	{
+		std::lock_guard<std::mutex> lock(m_Mutex);
+		for (Shader* shader : m_Shaders)
+		{
+			if (NormalisePath(shader->GetFilePath()) == changed)
+				targets.push_back(shader);
+		}
+	}
+	if (targets.empty())
+		return;
+
+	ShaderProgramSource source = Shader::ParseShader(filepath);
+
+	std::lock_guard<std::mutex> lock(m_Mutex);
+	for (Shader* shader : targets)
+		m_ParsedSources.push_back({ shader, source });
+}
+
+#ifdef __linux__
+
+void ShaderWatcher::WatchLoop()
+{
+	int fd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+	if (fd < 0)
+	{
+		Log::Error("Failed to start watching shaders!");
+		return;
+	}
+
+	//Directories are watched rather than the files because most editors save by replacing the file
+	std::unordered_map<int, fs::path> directories;
+	while (m_Running)
+	{
+		{
+			std::lock_guard<std::mutex> lock(m_Mutex);
+			for (Shader* shader : m_Shaders)
+			{
+				fs::path directory = fs::path(shader->GetFilePath()).parent_path();
+				if (directory.empty())
+					directory = ".";
+
+				bool watched = false;
+				for (const auto& entry : directories)
+					watched |= entry.second == directory;
+				if (watched)
+					continue;
+
+				int wd = inotify_add_watch(fd, directory.c_str(), IN_CLOSE_WRITE | IN_MOVED_TO | IN_CREATE);
+				if (wd >= 0)
+					directories[wd] = directory;
+			}
+		}
+
+		pollfd pfd = { fd, POLLIN, 0 };
+		if (poll(&pfd, 1, 100) <= 0)
+			continue;
+
+		alignas(inotify_event) char buffer[4096];
+		ssize_t length;
+		while ((length = read(fd, buffer, sizeof(buffer))) > 0)
+		{
+			for (char* ptr = buffer; ptr < buffer + length;)
+			{
+				const inotify_event* event = (const inotify_event*)ptr;
+				if (event->len > 0 && directories.count(event->wd))
+					QueueReload((directories[event->wd] / event->name).string());
+
+				ptr += sizeof(inotify_event) + event->len;
+			}
+		}
+	}
+
+	close(fd);
+}
+
+#else
+
+//Without inotify the modification times are polled, which is cheap for the handful of files we watch
+void ShaderWatcher::WatchLoop()
+{
+	std::unordered_map<std::string, fs::file_time_type> writeTimes;
+	while (m_Running)
+	{
+		std::vector<std::string> paths;
+		{
+			std::lock_guard<std::mutex> lock(m_Mutex);
+			for (Shader* shader : m_Shaders)
+				paths.push_back(shader->GetFilePath());
+		}
+
+		for (const auto& path : paths)
+		{
+			std::error_code error;
+			fs::file_time_type time = fs::last_write_time(path, error);
+			if (error)
+				continue;
+
+			auto it = writeTimes.find(path);
+			if (it == writeTimes.end())
+				writeTimes[path] = time;
+			else if (it->second != time)
+			{
+				it->second = time;
+				QueueReload(path);
+			}
+		}
+
+		std::this_thread::sleep_for(std::chrono::milliseconds(250));
+	}
+}
+
+#endif
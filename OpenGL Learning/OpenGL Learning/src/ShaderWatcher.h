@@ -0,0 +1,63 @@
+#pragma once
+
+#include <atomic>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "shader.h"
+
+//Watches the files of the shaders it is given on a background thread and hot reloads them.
+//The watch thread only reads and parses the changed file, the GL work is done in Update which
+//has to be called once per frame on the thread that owns the context. The watched shaders must outlive the watcher.
+//Without a parallel compile extension the compile, link and status check of a reload are spread over separate
+//frames, one step per frame, so a driver that compiles on the calling thread costs a hitch rather than a freeze.
+class ShaderWatcher
+{
+private:
+	struct ParsedSource
+	{
+		Shader* Target;
+		ShaderProgramSource Source;
+	};
+
+	enum class PendingStage
+	{
+		Parsed, Compiled, Linked
+	};
+
+	struct PendingProgram
+	{
+		Shader* Target;
+		ShaderProgramSource Source; //Only needed until it is compiled
+		unsigned int Program; //0 while parsed
+		PendingStage Stage;
+	};
+
+	std::thread m_Thread;
+	std::atomic<bool> m_Running;
+
+	std::mutex m_Mutex;
+	std::vector<Shader*> m_Shaders;
+	std::vector<ParsedSource> m_ParsedSources;
+
+	//Only touched by the GL thread
+	std::vector<PendingProgram> m_PendingPrograms;
+	bool m_ParallelCompile;
+
+public:
+	ShaderWatcher();
+	~ShaderWatcher();
+
+	void Watch(Shader& shader);
+
+	//Starts compiling any changed sources and swaps in the programs that have finished linking
+	void Update();
+
+private:
+	void WatchLoop();
+	void QueueReload(const std::string& filepath);
+	void Advance(PendingProgram& pending);
+	void Finish(PendingProgram& pending);
+};
@@ -1,24 +1,373 @@
 #include "Texture.h"
-#include "stb_image/stb_image.h"
+#include "MipChain.h"
+#include "BlockCompression.h"
+#include "ImageDecoder.h"
+#include "CpuProfiler.h"
+#include "GLDebugOutput.h"
+#include "Log.h"
+#include "RenderStats.h"
 
-Texture::Texture(const std::string& path)
-	: m_RendererID(0) ,m_FilePath(path),m_LocalBuffer(nullptr), m_Width(0), m_Height(0), m_BPP(0)
+#include <algorithm>
+#include <vector>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define TEXTURE_SSE2
+#include <emmintrin.h>
+#endif
+
+Texture::Texture(const std::string& path, const TextureOptions& options)
+	: m_RendererID(0) ,m_FilePath(path),m_LocalBuffer(nullptr), m_Width(0), m_Height(0), m_BPP(0), m_InternalFormat(0), m_MemoryUsage(0), m_Options(options)
+{
+	PROFILE_SCOPE("Load texture");
+	//Block compressed files already hold their mip chain and go straight to the GPU
+	if (IsCompressedImageFile(path))
+	{
+		CompressedImage image;
+		if (LoadCompressedImage(path, image))
+			CreateCompressed(image);
+		return;
+	}
+
+	m_LocalBuffer = DecodeImageFile(path, m_Width, m_Height, m_BPP, m_Options.Channels);
+	if (!m_LocalBuffer)
+	{
+		//No texture is created, binding it then binds nothing like a compressed file that failed to load
+		Log::Error("Failed to load texture {}: {}", path, GetImageFailureReason());
+		m_Width = m_Height = m_BPP = 0;
+		return;
+	}
+	if (m_Options.Channels != 0)
+		m_BPP = m_Options.Channels;
+	if (m_Options.Premultiply)
+		PremultiplyAlpha(m_LocalBuffer, (size_t)m_Width * m_Height, m_BPP);
+	Create(m_LocalBuffer);
+	GLDebugOutput::SetLabel(GL_TEXTURE, m_RendererID, path);
+
+	FreeImagePixels(m_LocalBuffer);
+	m_LocalBuffer = nullptr;
+}
+
+Texture::Texture(int width, int height, const unsigned char* data, const TextureOptions& options)
+	: m_RendererID(0), m_LocalBuffer(nullptr), m_Width(width), m_Height(height), m_BPP(options.Channels != 0 ? options.Channels : 4), m_InternalFormat(0), m_MemoryUsage(0), m_Options(options)
+{
+	//The caller's pixels are left as they are, only a copy is premultiplied
+	if (data && m_Options.Premultiply && (m_BPP == 2 || m_BPP == 4))
+	{
+		std::vector<unsigned char> premultiplied(data, data + (size_t)width * height * m_BPP);
+		PremultiplyAlpha(premultiplied.data(), (size_t)width * height, m_BPP);
+		Create(premultiplied.data());
+	}
+	else
+		Create(data);
+}
+
+Texture::Texture(int width, int height, unsigned int internalFormat, const TextureOptions& options)
+	: m_RendererID(0), m_LocalBuffer(nullptr), m_Width(width), m_Height(height), m_BPP(0), m_InternalFormat(0), m_MemoryUsage(0), m_Options(options)
+{
+	FormatInfo info;
+	if (!GetFormatInfo(internalFormat, info))
+	{
+		Log::Error("Texture format {} isn't supported, using GL_RGBA8!", internalFormat);
+		internalFormat = GL_RGBA8;
+		GetFormatInfo(internalFormat, info);
+	}
+	m_BPP = info.Channels;
+	m_InternalFormat = internalFormat;
+
+	GLCall(glGenTextures(1, &m_RendererID));
+	GLCall(glBindTexture(GL_TEXTURE_2D, m_RendererID));
+	RenderStats::Current().TexturesCreated++;
+	const bool mipmapped = m_Options.Mipmaps != TextureMipmaps::None;
+	CreateSampler(mipmapped);
+
+	m_MemoryUsage = (size_t)m_Width * m_Height * info.BytesPerTexel;
+	if (mipmapped)
+		m_MemoryUsage += m_MemoryUsage / 3;
+	AllocateStorage(mipmapped ? GetMipLevelCount(m_Width, m_Height) : 1, internalFormat);
+	GLCall(glBindTexture(GL_TEXTURE_2D, 0));
+}
+
+Texture::Texture(const CompressedImage& image, const TextureOptions& options)
+	: m_RendererID(0), m_LocalBuffer(nullptr), m_Width(0), m_Height(0), m_BPP(0), m_InternalFormat(0), m_MemoryUsage(0), m_Options(options)
+{
+	CreateCompressed(image);
+}
+
+void Texture::Create(const unsigned char* data)
 {
-	stbi_set_flip_vertically_on_load(1);
-	m_LocalBuffer = stbi_load(path.c_str(), &m_Width, &m_Height, &m_BPP, 4);
 	GLCall(glGenTextures(1, &m_RendererID));
 	GLCall(glBindTexture(GL_TEXTURE_2D, m_RendererID));
+	RenderStats::Current().TexturesCreated++;
+	const bool mipmapped = m_Options.Mipmaps != TextureMipmaps::None;
+	CreateSampler(mipmapped);
 
-	GLCall(glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR));
-	GLCall(glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR));
-	GLCall(glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE));
-	GLCall(glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE));
+	//Grey and grey alpha images are spread back out to RGBA when sampled, RGB already reads alpha as 1
+	if (m_BPP == 1)
+	{
+		const int swizzle[4] = { GL_RED, GL_RED, GL_RED, GL_ONE };
+		const int maskSwizzle[4] = { GL_ONE, GL_ONE, GL_ONE, GL_RED };
+		const int premultipliedMaskSwizzle[4] = { GL_RED, GL_RED, GL_RED, GL_RED }; //White times the mask
+		const int* chosen = m_Options.AlphaMask ? (m_Options.Premultiply ? premultipliedMaskSwizzle : maskSwizzle) : swizzle;
+		GLCall(glTexParameteriv(GL_TEXTURE_2D, GL_TEXTURE_SWIZZLE_RGBA, chosen));
+	}
+	else if (m_BPP == 2)
+	{
+		const int swizzle[4] = { GL_RED, GL_RED, GL_RED, GL_GREEN };
+		GLCall(glTexParameteriv(GL_TEXTURE_2D, GL_TEXTURE_SWIZZLE_RGBA, swizzle));
+	}
 
-	GLCall(glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, m_Width, m_Height, 0, GL_RGBA, GL_UNSIGNED_BYTE, m_LocalBuffer));
+	//A full mip chain adds a third on top of level 0
+	m_MemoryUsage = (size_t)m_Width * m_Height * m_BPP;
+	if (m_Options.Mipmaps != TextureMipmaps::None)
+		m_MemoryUsage += m_MemoryUsage / 3;
+
+	m_InternalFormat = GetInternalFormat(m_BPP);
+	if (!AllocateStorage(mipmapped ? GetMipLevelCount(m_Width, m_Height) : 1, m_InternalFormat))
+	{
+		GLCall(glBindTexture(GL_TEXTURE_2D, 0));
+		return;
+	}
+
+	if (data)
+	{
+		SetUnpackAlignment((size_t)m_Width * m_BPP);
+		GLCall(glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, m_Width, m_Height, GetDataFormat(m_BPP), GL_UNSIGNED_BYTE, data));
+		RenderStats::Current().TextureBytesUploaded += (size_t)m_Width * m_Height * m_BPP;
+		CreateMipmaps(data);
+	}
+	GLCall(glPixelStorei(GL_UNPACK_ALIGNMENT, 4)); //Back to the default for everything else that uploads RGBA
 	GLCall(glBindTexture(GL_TEXTURE_2D, 0));
+}
+
+//Expects the texture to be bound. Every level is allocated up front, after that only the contents are ever replaced
+bool Texture::AllocateStorage(int levels, unsigned int internalFormat)
+{
+	//GL rejects empty storage with GL_INVALID_VALUE, which stops the program when errors are checked strictly
+	if (m_Width <= 0 || m_Height <= 0)
+	{
+		Log::Error("Can't allocate a {}x{} texture!", m_Width, m_Height);
+		m_MemoryUsage = 0;
+		return false;
+	}
+
+	if (IsImmutableStorageSupported())
+	{
+		GLCall(glTexStorage2D(GL_TEXTURE_2D, levels, internalFormat, m_Width, m_Height));
+		return true;
+	}
+
+	FormatInfo info;
+	GetFormatInfo(internalFormat, info);
+	for (int i = 0; i < levels; i++)
+	{
+		GLCall(glTexImage2D(GL_TEXTURE_2D, i, internalFormat, std::max(1, m_Width >> i), std::max(1, m_Height >> i), 0, info.DataFormat, info.Type, nullptr));
+	}
+	GLCall(glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, levels - 1));
+	return true;
+}
+
+void Texture::CreateCompressed(const CompressedImage& image)
+{
+	if (!IsBlockFormatSupported(image.Format, image.SRGB))
+	{
+		Log::Error("The driver can't sample the block format of {}!", m_FilePath);
+		return;
+	}
+
+	m_Width = image.GetWidth();
+	m_Height = image.GetHeight();
+	m_BPP = 4;
+
+	GLCall(glGenTextures(1, &m_RendererID));
+	GLCall(glBindTexture(GL_TEXTURE_2D, m_RendererID));
+	RenderStats::Current().TexturesCreated++;
+
+	//The file decides whether there are mipmaps, they can't be generated for compressed formats
+	const bool mipmapped = image.Levels.size() > 1;
+	CreateSampler(mipmapped);
+	m_Options.Mipmaps = TextureMipmaps::None; //Keeps GenerateMipmaps away from the levels the file gave us
+
+	const unsigned int internalFormat = GetGLInternalFormat(image.Format, image.SRGB);
+	m_InternalFormat = internalFormat;
+	const bool immutable = IsImmutableStorageSupported();
+	if (immutable)
+	{
+		GLCall(glTexStorage2D(GL_TEXTURE_2D, (int)image.Levels.size(), internalFormat, m_Width, m_Height));
+	}
+	else
+	{
+		GLCall(glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, (int)image.Levels.size() - 1));
+	}
+
+	for (unsigned int i = 0; i < image.Levels.size(); i++)
+	{
+		const auto& level = image.Levels[i];
+		m_MemoryUsage += level.Data.size();
+		RenderStats::Current().TextureBytesUploaded += level.Data.size();
+		if (immutable)
+		{
+			GLCall(glCompressedTexSubImage2D(GL_TEXTURE_2D, i, 0, 0, level.Width, level.Height, internalFormat, (int)level.Data.size(), level.Data.data()));
+		}
+		else
+		{
+			GLCall(glCompressedTexImage2D(GL_TEXTURE_2D, i, internalFormat, level.Width, level.Height, 0, (int)level.Data.size(), level.Data.data()));
+		}
+	}
+	GLCall(glBindTexture(GL_TEXTURE_2D, 0));
+}
+
+void Texture::CreateSampler(bool mipmapped)
+{
+	SamplerState state;
+	if (mipmapped)
+		state.MinFilter = m_Options.Trilinear ? GL_LINEAR_MIPMAP_LINEAR : GL_LINEAR_MIPMAP_NEAREST;
+	state.Anisotropy = m_Options.Anisotropy;
+	m_Sampler = Sampler::Get(state);
+}
+
+//Expects the texture to be bound
+void Texture::CreateMipmaps(const unsigned char* data)
+{
+	if (m_Options.Mipmaps == TextureMipmaps::GPU)
+	{
+		GLCall(glGenerateMipmap(GL_TEXTURE_2D));
+	}
+	else if (m_Options.Mipmaps == TextureMipmaps::CPU)
+	{
+		//Textures made from memory have nowhere to cache their chain so it is rebuilt every time
+		//A mask holds coverage rather than colour so it is averaged as is
+		MipChain chain;
+		const std::string cachePath = GetMipCachePath(m_FilePath, m_Options);
+		const bool srgb = !(m_Options.AlphaMask && m_BPP == 1);
+		if (m_FilePath.empty() || !chain.Load(cachePath, m_FilePath, m_Width, m_Height, m_BPP, srgb))
+		{
+			chain = MipChain::Generate(data, m_Width, m_Height, m_BPP, srgb);
+			if (!m_FilePath.empty())
+				chain.Save(cachePath, m_FilePath, m_Width, m_Height);
+		}
+
+		const auto& levels = chain.GetLevels();
+		for (unsigned int i = 0; i < levels.size(); i++)
+		{
+			SetUnpackAlignment((size_t)levels[i].Width * m_BPP);
+			GLCall(glTexSubImage2D(GL_TEXTURE_2D, i + 1, 0, 0, levels[i].Width, levels[i].Height, GetDataFormat(m_BPP), GL_UNSIGNED_BYTE, levels[i].Pixels.data()));
+			RenderStats::Current().TextureBytesUploaded += levels[i].Pixels.size();
+		}
+	}
+}
+
+unsigned int Texture::GetInternalFormat(int channels)
+{
+	const unsigned int formats[4] = { GL_R8, GL_RG8, GL_RGB8, GL_RGBA8 };
+	return formats[std::min(std::max(channels, 1), 4) - 1];
+}
+
+bool Texture::GetFormatInfo(unsigned int internalFormat, FormatInfo& info)
+{
+	switch (internalFormat)
+	{
+		case GL_R8:             info = { GL_RED, GL_UNSIGNED_BYTE, 1, 1 }; return true;
+		case GL_RG8:            info = { GL_RG, GL_UNSIGNED_BYTE, 2, 2 }; return true;
+		case GL_RGB8:           info = { GL_RGB, GL_UNSIGNED_BYTE, 3, 3 }; return true;
+		case GL_RGBA8:          info = { GL_RGBA, GL_UNSIGNED_BYTE, 4, 4 }; return true;
+		case GL_SRGB8_ALPHA8:   info = { GL_RGBA, GL_UNSIGNED_BYTE, 4, 4 }; return true;
+		case GL_RGB10_A2:       info = { GL_RGBA, GL_UNSIGNED_INT_2_10_10_10_REV, 4, 4 }; return true;
+		case GL_R11F_G11F_B10F: info = { GL_RGB, GL_FLOAT, 3, 4 }; return true;
+		case GL_R16F:           info = { GL_RED, GL_HALF_FLOAT, 1, 2 }; return true;
+		case GL_RG16F:          info = { GL_RG, GL_HALF_FLOAT, 2, 4 }; return true;
+		case GL_RGBA16F:        info = { GL_RGBA, GL_HALF_FLOAT, 4, 8 }; return true;
+		case GL_R32F:           info = { GL_RED, GL_FLOAT, 1, 4 }; return true;
+		case GL_RG32F:          info = { GL_RG, GL_FLOAT, 2, 8 }; return true;
+		case GL_RGBA32F:        info = { GL_RGBA, GL_FLOAT, 4, 16 }; return true;
+	}
+	return false;
+}
+
+unsigned int Texture::GetDataFormat(int channels)
+{
+	const unsigned int formats[4] = { GL_RED, GL_RG, GL_RGB, GL_RGBA };
+	return formats[std::min(std::max(channels, 1), 4) - 1];
+}
+
+void Texture::SetUnpackAlignment(size_t rowSize)
+{
+	int alignment = 8;
+	while (rowSize % alignment != 0)
+		alignment /= 2;
+	GLCall(glPixelStorei(GL_UNPACK_ALIGNMENT, alignment));
+}
+
+bool Texture::IsImmutableStorageSupported()
+{
+	return GLEW_VERSION_4_2 || GLEW_ARB_texture_storage;
+}
+
+void Texture::PremultiplyAlpha(unsigned char* pixels, size_t pixelCount, int channels)
+{
+	if (channels != 2 && channels != 4)
+		return;
+
+	//c * a / 255 rounded exactly, t = c * a + 128 and then (t + (t >> 8)) >> 8
+	size_t i = 0;
+	const size_t size = pixelCount * channels;
+#ifdef TEXTURE_SSE2
+	//Each 16 bit lane is multiplied by its pixel's alpha, the alpha lanes by 255 so they come out unchanged
+	const __m128i zero = _mm_setzero_si128();
+	const __m128i alphaLanes = channels == 4 ? _mm_setr_epi16(0, 0, 0, -1, 0, 0, 0, -1) : _mm_setr_epi16(0, -1, 0, -1, 0, -1, 0, -1);
+	const __m128i alphaScale = _mm_and_si128(alphaLanes, _mm_set1_epi16(255));
+	const __m128i half = _mm_set1_epi16(128);
+
+	auto premultiply = [&](__m128i value)
+	{
+		__m128i alpha = channels == 4
+			? _mm_shufflehi_epi16(_mm_shufflelo_epi16(value, _MM_SHUFFLE(3, 3, 3, 3)), _MM_SHUFFLE(3, 3, 3, 3))
+			: _mm_shufflehi_epi16(_mm_shufflelo_epi16(value, _MM_SHUFFLE(3, 3, 1, 1)), _MM_SHUFFLE(3, 3, 1, 1));
+		alpha = _mm_or_si128(_mm_andnot_si128(alphaLanes, alpha), alphaScale);
+		__m128i t = _mm_add_epi16(_mm_mullo_epi16(value, alpha), half);
+		return _mm_srli_epi16(_mm_add_epi16(t, _mm_srli_epi16(t, 8)), 8);
+	};
 
-	if (m_LocalBuffer)
-		stbi_image_free(m_LocalBuffer);
+	for (; i + 16 <= size; i += 16)
+	{
+		__m128i value = _mm_loadu_si128((const __m128i*)(pixels + i));
+		__m128i low = premultiply(_mm_unpacklo_epi8(value, zero));
+		__m128i high = premultiply(_mm_unpackhi_epi8(value, zero));
+		_mm_storeu_si128((__m128i*)(pixels + i), _mm_packus_epi16(low, high));
+	}
+#endif
+
+	for (; i < size; i += channels)
+	{
+		const unsigned int alpha = pixels[i + channels - 1];
+		for (int c = 0; c < channels - 1; c++)
+		{
+			unsigned int t = pixels[i + c] * alpha + 128;
+			pixels[i + c] = (unsigned char)((t + (t >> 8)) >> 8);
+		}
+	}
+}
+
+std::string Texture::GetMipCachePath(const std::string& path, const TextureOptions& options)
+{
+	return path + (options.AlphaMask ? ".mask" : "") + (options.Premultiply ? ".premultiplied.mips" : ".mips");
+}
+
+int Texture::GetMipLevelCount(int width, int height)
+{
+	int levels = 1;
+	for (int size = std::max(width, height); size > 1; size /= 2)
+		levels++;
+	return levels;
+}
+
+void Texture::GenerateMipmaps()
+{
+	if (m_Options.Mipmaps == TextureMipmaps::None)
+		return;
+
+	GLCall(glBindTexture(GL_TEXTURE_2D, m_RendererID));
+	GLCall(glGenerateMipmap(GL_TEXTURE_2D));
+	GLCall(glBindTexture(GL_TEXTURE_2D, 0));
 }
 
 Texture::~Texture()
@@ -28,8 +377,22 @@ Texture::~Texture()
 
 void Texture::Bind(unsigned int slot) const
 {
+	RenderStats::Current().TextureBinds++;
+	GLCall(glActiveTexture(GL_TEXTURE0 + slot));
+	GLCall(glBindTexture(GL_TEXTURE_2D, m_RendererID));
+	//Textures that failed to load have no sampler, the slot still has to stop using whatever was bound before
+	if (m_Sampler)
+		m_Sampler->Bind(slot);
+	else
+		Sampler::UnBind(slot);
+}
+
+void Texture::Bind(unsigned int slot, const Sampler& sampler) const
+{
+	RenderStats::Current().TextureBinds++;
 	GLCall(glActiveTexture(GL_TEXTURE0 + slot));
 	GLCall(glBindTexture(GL_TEXTURE_2D, m_RendererID));
+	sampler.Bind(slot);
 }
 void Texture::UnBind() const
 {
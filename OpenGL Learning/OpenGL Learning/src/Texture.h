@@ -1,7 +1,32 @@
 #pragma once
 
+#include <memory>
+#include <string>
+
 #include "Renderer.h"
+#include "Sampler.h"
+
+struct CompressedImage;
+
+enum class TextureMipmaps
+{
+	None, //Only level 0, sampled with plain GL_LINEAR
+	GPU, //glGenerateMipmap, fast but the filter is up to the driver
+	CPU //Gamma correct MipChain, cached next to the source file as <path>.mips
+};
+
+struct TextureOptions
+{
+	TextureMipmaps Mipmaps = TextureMipmaps::None;
+	bool Trilinear = true; //Blend between mip levels instead of snapping to the nearest one
+	float Anisotropy = 1.0f; //Clamped to what the driver supports, 1 turns it off
+	int Channels = 0; //How many channels to store, 0 keeps what the image has. Missing ones are swizzled so shaders still read RGBA
+	bool AlphaMask = false; //Single channel images read as white with the channel in alpha, for fonts and UI masks
+	bool Premultiply = false; //Multiplies colour by alpha as the image loads, for drawing with BlendMode::Premultiplied
+};
 
+//Storage is immutable where the driver supports it, only the contents change after creation. Filtering and
+//wrapping live in a shared Sampler picked from the options, which Bind binds alongside the texture.
 class Texture
 {
 private:
@@ -9,14 +34,66 @@ private:
 	std::string m_FilePath;
 	unsigned char* m_LocalBuffer;
 	int m_Width, m_Height, m_BPP;
+	unsigned int m_InternalFormat;
+	size_t m_MemoryUsage;
+	TextureOptions m_Options;
+	std::shared_ptr<Sampler> m_Sampler;
 
 public:
-	Texture(const std::string& path);
+	//.dds and .ktx2 files are uploaded block compressed with the mip levels they contain, anything else through DecodeImageFile
+	Texture(const std::string& path, const TextureOptions& options = TextureOptions());
+	//Makes an RGBA8 texture from pixels already in memory, if data is null the storage is left uninitialised
+	Texture(int width, int height, const unsigned char* data = nullptr, const TextureOptions& options = TextureOptions());
+	//An empty texture of any uncompressed sized format, for render targets. Only the options' sampling and mipmap mode are used
+	Texture(int width, int height, unsigned int internalFormat, const TextureOptions& options = TextureOptions());
+	//Uploads every level of an image from LoadCompressedImage, the options' mipmap mode is ignored
+	Texture(const CompressedImage& image, const TextureOptions& options = TextureOptions());
 	~Texture();
 
 	void Bind(unsigned int slot = 0) const;
+	//Samples the texture with a different sampler than its own, e.g. point filtering for a debug view
+	void Bind(unsigned int slot, const Sampler& sampler) const;
 	void UnBind() const;
 
+	//Rebuilds the mip levels from level 0 on the GPU, for textures whose contents were changed after creation
+	void GenerateMipmaps();
+
 	inline int GetWidth() const { return m_Width; } 
 	inline int GetHeight() const { return m_Height; } 
-};
\ No newline at end of file
+	inline unsigned int GetRendererID() const { return m_RendererID; }
+	inline int GetChannels() const { return m_BPP; }
+	//The sized internal format, 0 if the texture failed to load
+	inline unsigned int GetFormat() const { return m_InternalFormat; }
+	//Roughly what the texture takes up in video memory, including its mip levels
+	inline size_t GetMemoryUsage() const { return m_MemoryUsage; }
+	inline const Sampler& GetSampler() const { return *m_Sampler; }
+
+	//GL_R8, GL_RG8, GL_RGB8 or GL_RGBA8 and the matching GL_RED ... GL_RGBA for a channel count
+	static unsigned int GetInternalFormat(int channels);
+	static unsigned int GetDataFormat(int channels);
+	//Rows of 1, 2 or 3 channel images don't always land on the default 4 byte alignment
+	static void SetUnpackAlignment(size_t rowSize);
+	//glTexStorage2D needs GL 4.2 or ARB_texture_storage, without it every level is allocated with glTexImage2D
+	static bool IsImmutableStorageSupported();
+	//Levels in a full chain down to 1x1
+	static int GetMipLevelCount(int width, int height);
+	//Multiplies the colour of 2 and 4 channel pixels by their alpha in place, other channel counts are left alone
+	static void PremultiplyAlpha(unsigned char* pixels, size_t pixelCount, int channels);
+	//Where a CPU mip chain for the file is cached, premultiplied and mask chains are kept apart from plain ones
+	static std::string GetMipCachePath(const std::string& path, const TextureOptions& options);
+
+	//What glTexImage2D needs to allocate an uncompressed sized format, false for formats this doesn't know
+	struct FormatInfo
+	{
+		unsigned int DataFormat, Type;
+		int Channels, BytesPerTexel;
+	};
+	static bool GetFormatInfo(unsigned int internalFormat, FormatInfo& info);
+
+private:
+	void Create(const unsigned char* data);
+	void CreateCompressed(const CompressedImage& image);
+	bool AllocateStorage(int levels, unsigned int internalFormat);
+	void CreateSampler(bool mipmapped);
+	void CreateMipmaps(const unsigned char* data);
+};
@@ -0,0 +1,121 @@
+#include "Texture2DArray.h"
+#include "ImageDecoder.h"
+#include "Texture.h"
+#include "Log.h"
+#include "RenderStats.h"
+
+Texture2DArray::Texture2DArray(const std::vector<std::string>& paths, bool premultiply)
+	: m_RendererID(0), m_Width(0), m_Height(0), m_Layers((int)paths.size())
+{
+	//Layers are independent files so they are all decoded at once before any are uploaded
+	std::vector<DecodedImageFile> images = DecodeImageFiles(paths, 4);
+
+	for (int layer = 0; layer < m_Layers; layer++)
+	{
+		const int width = images[layer].Width, height = images[layer].Height;
+		unsigned char* pixels = images[layer].Pixels;
+		if (!pixels)
+		{
+			Log::Error("Failed to load texture array layer {}: {}", paths[layer], images[layer].FailureReason);
+			continue;
+		}
+
+		//The first image that loads decides the size of every layer
+		if (m_RendererID == 0)
+		{
+			m_Width = width;
+			m_Height = height;
+			Create();
+		}
+
+		if (width == m_Width && height == m_Height)
+		{
+			if (premultiply)
+				Texture::PremultiplyAlpha(pixels, (size_t)width * height, 4);
+			SetLayer(layer, pixels);
+		}
+		else
+			Log::Error("Texture array layer {} is {}x{} but the array is {}x{}!", paths[layer], width, height, m_Width, m_Height);
+
+		FreeImagePixels(pixels);
+	}
+}
+
+Texture2DArray::Texture2DArray(int width, int height, int layers)
+	: m_RendererID(0), m_Width(width), m_Height(height), m_Layers(layers)
+{
+	Create();
+}
+
+Texture2DArray::~Texture2DArray()
+{
+	GLCall(glDeleteTextures(1, &m_RendererID));
+}
+
+void Texture2DArray::Create()
+{
+	int maxLayers;
+	GLCall(glGetIntegerv(GL_MAX_ARRAY_TEXTURE_LAYERS, &maxLayers));
+	if (m_Layers > maxLayers)
+	{
+		Log::Error("Texture array has {} layers but only {} are supported!", m_Layers, maxLayers);
+		m_Layers = maxLayers;
+	}
+
+	GLCall(glGenTextures(1, &m_RendererID));
+	GLCall(glBindTexture(GL_TEXTURE_2D_ARRAY, m_RendererID));
+	RenderStats::Current().TexturesCreated++;
+
+	m_Sampler = Sampler::Get(SamplerState());
+
+	if (Texture::IsImmutableStorageSupported())
+	{
+		GLCall(glTexStorage3D(GL_TEXTURE_2D_ARRAY, 1, GL_RGBA8, m_Width, m_Height, m_Layers));
+	}
+	else
+	{
+		GLCall(glTexImage3D(GL_TEXTURE_2D_ARRAY, 0, GL_RGBA8, m_Width, m_Height, m_Layers, 0, GL_RGBA, GL_UNSIGNED_BYTE, nullptr));
+		GLCall(glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MAX_LEVEL, 0));
+	}
+	GLCall(glBindTexture(GL_TEXTURE_2D_ARRAY, 0));
+}
+
+void Texture2DArray::SetLayer(int layer, const unsigned char* pixels)
+{
+	if (layer >= m_Layers)
+		return;
+
+	GLCall(glBindTexture(GL_TEXTURE_2D_ARRAY, m_RendererID));
+	GLCall(glTexSubImage3D(GL_TEXTURE_2D_ARRAY, 0, 0, 0, layer, m_Width, m_Height, 1, GL_RGBA, GL_UNSIGNED_BYTE, pixels));
+	RenderStats::Current().TextureBytesUploaded += (size_t)m_Width * m_Height * 4;
+	GLCall(glBindTexture(GL_TEXTURE_2D_ARRAY, 0));
+}
+
+void Texture2DArray::SetRegion(int layer, int x, int y, int width, int height, const unsigned char* pixels, int rowLength)
+{
+	if (layer >= m_Layers || width <= 0 || height <= 0)
+		return;
+
+	GLCall(glBindTexture(GL_TEXTURE_2D_ARRAY, m_RendererID));
+	GLCall(glPixelStorei(GL_UNPACK_ROW_LENGTH, rowLength));
+	GLCall(glTexSubImage3D(GL_TEXTURE_2D_ARRAY, 0, x, y, layer, width, height, 1, GL_RGBA, GL_UNSIGNED_BYTE, pixels));
+	GLCall(glPixelStorei(GL_UNPACK_ROW_LENGTH, 0));
+	RenderStats::Current().TextureBytesUploaded += (size_t)width * height * 4;
+	GLCall(glBindTexture(GL_TEXTURE_2D_ARRAY, 0));
+}
+
+void Texture2DArray::Bind(unsigned int slot) const
+{
+	RenderStats::Current().TextureBinds++;
+	GLCall(glActiveTexture(GL_TEXTURE0 + slot));
+	GLCall(glBindTexture(GL_TEXTURE_2D_ARRAY, m_RendererID));
+	if (m_Sampler)
+		m_Sampler->Bind(slot);
+	else
+		Sampler::UnBind(slot);
+}
+
+void Texture2DArray::UnBind() const
+{
+	GLCall(glBindTexture(GL_TEXTURE_2D_ARRAY, 0));
+}
@@ -0,0 +1,43 @@
+#pragma once
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "Renderer.h"
+#include "Sampler.h"
+
+//Many same sized RGBA8 images stored as the layers of one GL_TEXTURE_2D_ARRAY. A single bind covers every
+//layer and shaders pick one with the third texture coordinate, so sprites using different images still batch.
+class Texture2DArray
+{
+private:
+	unsigned int m_RendererID;
+	int m_Width, m_Height, m_Layers;
+	std::shared_ptr<Sampler> m_Sampler;
+
+public:
+	//Layer i is loaded from paths[i], every image must be the size of the first one.
+	//Premultiply multiplies colour by alpha before upload, for drawing with BlendMode::Premultiplied
+	Texture2DArray(const std::vector<std::string>& paths, bool premultiply = false);
+	//Allocates empty layers to be filled with SetLayer
+	Texture2DArray(int width, int height, int layers);
+	~Texture2DArray();
+
+	//Replaces one layer with RGBA8 pixels, bottom row first
+	void SetLayer(int layer, const unsigned char* pixels);
+	//Replaces a rectangle of one layer. pixels points at its bottom left texel and rowLength is the width in
+	//texels of the image it is cut from, 0 when the rectangle's rows are tightly packed
+	void SetRegion(int layer, int x, int y, int width, int height, const unsigned char* pixels, int rowLength = 0);
+
+	void Bind(unsigned int slot = 0) const;
+	void UnBind() const;
+
+	inline int GetWidth() const { return m_Width; }
+	inline int GetHeight() const { return m_Height; }
+	inline int GetLayerCount() const { return m_Layers; }
+	inline unsigned int GetRendererID() const { return m_RendererID; }
+
+private:
+	void Create();
+};
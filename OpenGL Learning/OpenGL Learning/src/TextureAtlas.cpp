@@ -0,0 +1,145 @@
+#include "TextureAtlas.h"
+#include "ImageDecoder.h"
+
+//imgui_draw.cpp compiles its own static copy, this one is private to the atlas
+#define STBRP_STATIC
+#define STB_RECT_PACK_IMPLEMENTATION
+#include "imgui/imstb_rectpack.h"
+#include "Log.h"
+
+#include <algorithm>
+#include <cstring>
+#include <filesystem>
+
+TextureAtlas::TextureAtlas(int pageSize, int padding, bool premultiply)
+	: m_PageSize(pageSize), m_Padding(padding), m_Premultiply(premultiply)
+{
+}
+
+bool TextureAtlas::Add(const std::string& path)
+{
+	int width, height, bpp;
+	unsigned char* pixels = DecodeImageFile(path, width, height, bpp, 4);
+	if (!pixels)
+	{
+		Log::Error("Failed to load atlas image {}: {}", path, GetImageFailureReason());
+		return false;
+	}
+
+	Add(path, width, height, pixels);
+	FreeImagePixels(pixels);
+	return true;
+}
+
+void TextureAtlas::Add(const std::string& name, int width, int height, const unsigned char* pixels)
+{
+	m_Sources.push_back({ name, width, height, std::vector<unsigned char>(pixels, pixels + (size_t)width * height * 4) });
+}
+
+unsigned int TextureAtlas::AddDirectory(const std::string& directory)
+{
+	unsigned int added = 0;
+	std::error_code error;
+	for (const auto& entry : std::filesystem::directory_iterator(directory, error))
+	{
+		std::string extension = entry.path().extension().string();
+		std::transform(extension.begin(), extension.end(), extension.begin(), ::tolower);
+		if (extension != ".png" && extension != ".jpg" && extension != ".jpeg" && extension != ".tga" && extension != ".bmp")
+			continue;
+
+		if (Add(entry.path().generic_string()))
+			added++;
+	}
+	return added;
+}
+
+//Copies the image into the page and repeats its outer texels out into the padding
+static void BlitExtruded(unsigned char* page, int pageSize, const unsigned char* pixels, int width, int height, int x, int y, int padding)
+{
+	for (int row = -padding; row < height + padding; row++)
+	{
+		int srcRow = std::min(std::max(row, 0), height - 1);
+		unsigned char* dst = page + ((size_t)(y + row) * pageSize + x) * 4;
+		const unsigned char* src = pixels + (size_t)srcRow * width * 4;
+
+		for (int column = -padding; column < 0; column++)
+			memcpy(dst + column * 4, src, 4);
+		memcpy(dst, src, (size_t)width * 4);
+		for (int column = width; column < width + padding; column++)
+			memcpy(dst + column * 4, src + (width - 1) * 4, 4);
+	}
+}
+
+void TextureAtlas::Build()
+{
+	//Bigger images first packs noticeably tighter
+	std::vector<stbrp_rect> remaining;
+	for (int i = 0; i < (int)m_Sources.size(); i++)
+	{
+		const SourceImage& source = m_Sources[i];
+		int paddedWidth = source.Width + m_Padding * 2;
+		int paddedHeight = source.Height + m_Padding * 2;
+		if (paddedWidth > m_PageSize || paddedHeight > m_PageSize)
+		{
+			Log::Error("Atlas image {} is too big for a {} page!", source.Name, m_PageSize);
+			continue;
+		}
+
+		stbrp_rect rect = {};
+		rect.id = i;
+		rect.w = (stbrp_coord)paddedWidth;
+		rect.h = (stbrp_coord)paddedHeight;
+		remaining.push_back(rect);
+	}
+	std::sort(remaining.begin(), remaining.end(), [](const stbrp_rect& a, const stbrp_rect& b) { return a.h > b.h; });
+
+	std::vector<stbrp_node> nodes(m_PageSize);
+	std::vector<unsigned char> pixels;
+	while (!remaining.empty())
+	{
+		stbrp_context context;
+		stbrp_init_target(&context, m_PageSize, m_PageSize, nodes.data(), (int)nodes.size());
+		stbrp_pack_rects(&context, remaining.data(), (int)remaining.size());
+
+		pixels.assign((size_t)m_PageSize * m_PageSize * 4, 0);
+		unsigned int pageIndex = (unsigned int)m_Pages.size();
+		std::vector<stbrp_rect> unpacked;
+
+		for (const auto& rect : remaining)
+		{
+			if (!rect.was_packed)
+			{
+				unpacked.push_back(rect);
+				continue;
+			}
+
+			const SourceImage& source = m_Sources[rect.id];
+			int x = rect.x + m_Padding;
+			int y = rect.y + m_Padding;
+			BlitExtruded(pixels.data(), m_PageSize, source.Pixels.data(), source.Width, source.Height, x, y, m_Padding);
+
+			float size = (float)m_PageSize;
+			m_Regions[source.Name] = { nullptr, pageIndex, glm::vec4(x / size, y / size, (x + source.Width) / size, (y + source.Height) / size), source.Width, source.Height };
+		}
+
+		//Done on the finished page so the extruded padding is premultiplied along with the images
+		if (m_Premultiply)
+			Texture::PremultiplyAlpha(pixels.data(), pixels.size() / 4, 4);
+
+		m_Pages.push_back(std::make_unique<Texture>(m_PageSize, m_PageSize, pixels.data()));
+		remaining.swap(unpacked);
+	}
+
+	//The pages only exist once their pixels have been filled in, so the regions are pointed at them last
+	for (auto& region : m_Regions)
+		region.second.Page = m_Pages[region.second.PageIndex].get();
+
+	m_Sources.clear();
+	m_Sources.shrink_to_fit();
+}
+
+const AtlasRegion* TextureAtlas::Find(const std::string& name) const
+{
+	auto it = m_Regions.find(name);
+	return it != m_Regions.end() ? &it->second : nullptr;
+}
@@ -0,0 +1,60 @@
+#pragma once
+
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "Texture.h"
+
+//Where an image ended up inside an atlas page. Binding it binds the whole page,
+//so the UVs have to be remapped into UVRect (x,y = bottom left, z,w = top right) by whoever draws it
+struct AtlasRegion
+{
+	const Texture* Page;
+	unsigned int PageIndex;
+	glm::vec4 UVRect;
+	int Width, Height;
+
+	inline void Bind(unsigned int slot = 0) const { Page->Bind(slot); }
+	inline glm::vec2 MapUV(const glm::vec2& uv) const { return glm::vec2(UVRect.x, UVRect.y) + uv * glm::vec2(UVRect.z - UVRect.x, UVRect.w - UVRect.y); }
+};
+
+//Packs many images into a few large textures with stb_rect_pack so sprites sharing a page
+//can be drawn without switching textures. Images are added first and uploaded together by Build.
+class TextureAtlas
+{
+private:
+	struct SourceImage
+	{
+		std::string Name;
+		int Width, Height;
+		std::vector<unsigned char> Pixels;
+	};
+
+	int m_PageSize;
+	int m_Padding;
+	bool m_Premultiply;
+	std::vector<SourceImage> m_Sources;
+	std::vector<std::unique_ptr<Texture>> m_Pages;
+	std::unordered_map<std::string, AtlasRegion> m_Regions;
+
+public:
+	//Padding is filled by extruding the edge texels so filtering never bleeds in a neighbour.
+	//Premultiply multiplies colour by alpha before the pages upload, for drawing with BlendMode::Premultiplied
+	TextureAtlas(int pageSize = 2048, int padding = 2, bool premultiply = false);
+
+	//The region is looked up by path afterwards
+	bool Add(const std::string& path);
+	//RGBA8 pixels, bottom row first like everything else uploaded to GL
+	void Add(const std::string& name, int width, int height, const unsigned char* pixels);
+	//Adds every image in the directory, returns how many were added
+	unsigned int AddDirectory(const std::string& directory);
+
+	//Packs everything added so far into pages and uploads them, the CPU copies are released afterwards
+	void Build();
+
+	const AtlasRegion* Find(const std::string& name) const;
+	inline unsigned int GetPageCount() const { return (unsigned int)m_Pages.size(); }
+	inline const Texture& GetPage(unsigned int index) const { return *m_Pages[index]; }
+};
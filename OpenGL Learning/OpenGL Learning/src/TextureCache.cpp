@@ -0,0 +1,99 @@
+#include "TextureCache.h"
+
+#include <algorithm>
+#include <vector>
+
+TextureCache::TextureCache(TextureLoader& loader, size_t budgetBytes)
+	: m_Loader(loader), m_Budget(budgetBytes), m_ResidentBytes(0), m_Frame(0)
+{
+}
+
+std::string TextureCache::MakeKey(const std::string& path, const TextureOptions& options)
+{
+	//The same file loaded with different options is a different texture on the GPU
+	return path + "|" + std::to_string((int)options.Mipmaps) + std::to_string(options.Trilinear) + std::to_string(options.Anisotropy)
+		+ std::to_string(options.Channels) + std::to_string(options.AlphaMask) + std::to_string(options.Premultiply);
+}
+
+TextureHandle TextureCache::Get(const std::string& path, const TextureOptions& options)
+{
+	const std::string key = MakeKey(path, options);
+	auto it = m_Textures.find(key);
+	if (it != m_Textures.end())
+	{
+		it->second.LastUsedFrame = m_Frame;
+		return TextureHandle(it->second.Entry, m_Loader.m_Placeholder.get());
+	}
+
+	TextureHandle handle = m_Loader.Load(path, options);
+	m_Textures[key] = { handle.m_Entry, m_Frame };
+	return handle;
+}
+
+void TextureCache::Update()
+{
+	std::vector<Record*> resident;
+	m_ResidentBytes = 0;
+	for (auto& [key, record] : m_Textures)
+	{
+		auto& entry = *record.Entry;
+		if (entry.Bound)
+		{
+			record.LastUsedFrame = m_Frame;
+			entry.Bound = false;
+
+			//Evicted while something still holds it, bring it back. A file that failed to load keeps the
+			//placeholder instead of being decoded and logged again every frame
+			if (!entry.Resident && !entry.Loading && !entry.Failed)
+				m_Loader.Queue(record.Entry);
+		}
+
+		if (entry.Resident)
+		{
+			m_ResidentBytes += entry.Resident->GetMemoryUsage();
+			resident.push_back(&record);
+		}
+	}
+
+	if (m_ResidentBytes > m_Budget)
+	{
+		//Textures nobody holds go first, then the ones bound longest ago
+		std::sort(resident.begin(), resident.end(), [](const Record* a, const Record* b)
+		{
+			bool aHeld = a->Entry.use_count() > 1, bHeld = b->Entry.use_count() > 1;
+			if (aHeld != bHeld)
+				return !aHeld;
+			return a->LastUsedFrame < b->LastUsedFrame;
+		});
+
+		for (Record* record : resident)
+		{
+			if (m_ResidentBytes <= m_Budget)
+				break;
+			//Anything drawn this frame would only be loaded straight back in
+			if (record->LastUsedFrame == m_Frame)
+				continue;
+
+			m_ResidentBytes -= record->Entry->Resident->GetMemoryUsage();
+			record->Entry->Resident.reset();
+		}
+	}
+
+	m_Frame++;
+}
+
+void TextureCache::Purge()
+{
+	for (auto it = m_Textures.begin(); it != m_Textures.end();)
+	{
+		//Entries still queued are held by the loader too, a later Purge picks them up
+		if (it->second.Entry.use_count() == 1)
+		{
+			if (it->second.Entry->Resident)
+				m_ResidentBytes -= it->second.Entry->Resident->GetMemoryUsage();
+			it = m_Textures.erase(it);
+		}
+		else
+			it++;
+	}
+}
@@ -0,0 +1,44 @@
+#pragma once
+
+#include <string>
+#include <unordered_map>
+
+#include "TextureLoader.h"
+
+//Hands out shared handles so each path and set of options is only loaded once, and keeps the video memory
+//used by its textures under a budget by evicting the ones bound least recently. Evicted textures fall back
+//to the loader's placeholder and are loaded again the next time they are bound. Update has to be called
+//once per frame after everything has been drawn, and the cache must outlive its handles.
+class TextureCache
+{
+private:
+	struct Record
+	{
+		std::shared_ptr<TextureHandle::Entry> Entry;
+		unsigned int LastUsedFrame;
+	};
+
+	TextureLoader& m_Loader;
+	std::unordered_map<std::string, Record> m_Textures;
+	size_t m_Budget;
+	size_t m_ResidentBytes;
+	unsigned int m_Frame;
+
+public:
+	TextureCache(TextureLoader& loader, size_t budgetBytes = 512 * 1024 * 1024);
+
+	TextureHandle Get(const std::string& path, const TextureOptions& options = TextureOptions());
+
+	//Reloads evicted textures that were bound this frame, then evicts until the budget is met
+	void Update();
+	//Drops every texture nobody holds a handle to, e.g. after unloading a scene
+	void Purge();
+
+	inline void SetBudget(size_t budgetBytes) { m_Budget = budgetBytes; }
+	inline size_t GetBudget() const { return m_Budget; }
+	inline size_t GetResidentBytes() const { return m_ResidentBytes; }
+	inline unsigned int GetTextureCount() const { return (unsigned int)m_Textures.size(); }
+
+private:
+	static std::string MakeKey(const std::string& path, const TextureOptions& options);
+};
@@ -0,0 +1,261 @@
+#include "TextureLoader.h"
+#include "ImageDecoder.h"
+#include "CpuProfiler.h"
+#include "Log.h"
+#include "RenderStats.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+
+void TextureHandle::Bind(unsigned int slot) const
+{
+	if (m_Entry)
+		m_Entry->Bound = true;
+
+	if (IsResident())
+		m_Entry->Resident->Bind(slot);
+	else if (m_Placeholder)
+		m_Placeholder->Bind(slot);
+}
+
+TextureLoader::TextureLoader(unsigned int threadCount)
+	: m_Running(true), m_NextPixelBuffer(0)
+{
+	//A single grey texel so anything drawn with a loading texture is still visible
+	const unsigned char grey[4] = { 128, 128, 128, 255 };
+	m_Placeholder = std::make_unique<Texture>(1, 1, grey);
+
+	GLCall(glGenBuffers(PixelBufferCount, m_PixelBuffers));
+	RenderStats::Current().BuffersCreated += PixelBufferCount;
+	for (int i = 0; i < PixelBufferCount; i++)
+	{
+		GLCall(glBindBuffer(GL_PIXEL_UNPACK_BUFFER, m_PixelBuffers[i]));
+		GLCall(glBufferData(GL_PIXEL_UNPACK_BUFFER, PixelBufferSize, nullptr, GL_STREAM_DRAW));
+	}
+	GLCall(glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0));
+
+	//hardware_concurrency is 0 when the core count can't be found
+	if (threadCount == 0)
+	{
+		unsigned int cores = std::thread::hardware_concurrency();
+		threadCount = cores > 1 ? cores - 1 : 1;
+	}
+	for (unsigned int i = 0; i < threadCount; i++)
+		m_Workers.emplace_back(&TextureLoader::WorkerLoop, this);
+}
+
+TextureLoader::~TextureLoader()
+{
+	{
+		std::lock_guard<std::mutex> lock(m_Mutex);
+		m_Running = false;
+	}
+	m_Condition.notify_all();
+	for (auto& worker : m_Workers)
+		worker.join();
+
+	for (auto& image : m_Decoded)
+		FreeImagePixels(image.Pixels);
+	if (m_Uploading)
+		FreeImagePixels(m_Uploading->Pixels);
+
+	GLCall(glDeleteBuffers(PixelBufferCount, m_PixelBuffers));
+}
+
+TextureHandle TextureLoader::Load(const std::string& path, const TextureOptions& options)
+{
+	auto entry = std::make_shared<TextureHandle::Entry>();
+	entry->FilePath = path;
+	entry->Options = options;
+	Queue(entry);
+
+	return TextureHandle(entry, m_Placeholder.get());
+}
+
+void TextureLoader::Queue(const std::shared_ptr<TextureHandle::Entry>& entry)
+{
+	entry->Failed = false;
+	entry->Loading = true;
+	{
+		std::lock_guard<std::mutex> lock(m_Mutex);
+		m_Requests.push_back(entry);
+	}
+	m_Condition.notify_one();
+}
+
+void TextureLoader::WorkerLoop()
+{
+	CpuProfiler::SetThreadName("Texture loader");
+	while (true)
+	{
+		std::shared_ptr<TextureHandle::Entry> entry;
+		{
+			std::unique_lock<std::mutex> lock(m_Mutex);
+			m_Condition.wait(lock, [this] { return !m_Running || !m_Requests.empty(); });
+			if (!m_Running)
+				return;
+
+			entry = m_Requests.front();
+			m_Requests.pop_front();
+		}
+
+		PROFILE_SCOPE("Decode texture");
+
+		//Nobody is holding a handle to it anymore
+		if (entry.use_count() == 1)
+		{
+			entry->Loading = false;
+			continue;
+		}
+
+		//Compressed files are small and uploaded whole, so they skip the pixel buffers
+		if (IsCompressedImageFile(entry->FilePath))
+		{
+			auto image = std::make_unique<CompressedImage>();
+			if (!LoadCompressedImage(entry->FilePath, *image))
+			{
+				entry->Failed = true;
+				entry->Loading = false;
+				continue;
+			}
+
+			std::lock_guard<std::mutex> lock(m_Mutex);
+			m_Decoded.push_back({ entry, nullptr, image->GetWidth(), image->GetHeight(), 4, 0, MipChain(), nullptr, std::move(image) });
+			continue;
+		}
+
+		int width, height, channels;
+		unsigned char* pixels = DecodeImageFile(entry->FilePath, width, height, channels, entry->Options.Channels);
+		if (!pixels)
+		{
+			Log::Error("Failed to load texture {}: {}", entry->FilePath, GetImageFailureReason());
+			entry->Failed = true;
+			entry->Loading = false;
+			continue;
+		}
+		if (entry->Options.Channels != 0)
+			channels = entry->Options.Channels;
+		if (entry->Options.Premultiply)
+			Texture::PremultiplyAlpha(pixels, (size_t)width * height, channels);
+
+		//The mip chain is the expensive part of a CPU mipmapped texture so it is built here too
+		MipChain mips;
+		if (entry->Options.Mipmaps == TextureMipmaps::CPU)
+		{
+			const std::string cachePath = Texture::GetMipCachePath(entry->FilePath, entry->Options);
+			const bool srgb = !(entry->Options.AlphaMask && channels == 1);
+			if (!mips.Load(cachePath, entry->FilePath, width, height, channels, srgb))
+			{
+				mips = MipChain::Generate(pixels, width, height, channels, srgb);
+				mips.Save(cachePath, entry->FilePath, width, height);
+			}
+		}
+
+		std::lock_guard<std::mutex> lock(m_Mutex);
+		m_Decoded.push_back({ entry, pixels, width, height, channels, 0, std::move(mips), nullptr, nullptr });
+	}
+}
+
+void TextureLoader::Update(float budgetMs)
+{
+	PROFILE_SCOPE("Upload textures");
+	auto start = std::chrono::steady_clock::now();
+	auto elapsed = [&start]()
+	{
+		return std::chrono::duration<float, std::milli>(std::chrono::steady_clock::now() - start).count();
+	};
+
+	while (elapsed() < budgetMs)
+	{
+		if (!m_Uploading)
+		{
+			std::lock_guard<std::mutex> lock(m_Mutex);
+			if (m_Decoded.empty())
+				break;
+
+			m_Uploading = std::make_unique<DecodedImage>(std::move(m_Decoded.front()));
+			m_Decoded.pop_front();
+		}
+
+		if (UploadRows(*m_Uploading))
+		{
+			FreeImagePixels(m_Uploading->Pixels);
+			m_Uploading.reset();
+		}
+	}
+}
+
+bool TextureLoader::UploadRows(DecodedImage& image)
+{
+	if (image.Compressed)
+	{
+		image.Target->Resident = std::make_unique<Texture>(*image.Compressed, image.Target->Options);
+		image.Target->Loading = false;
+		return true;
+	}
+
+	if (!image.Staging)
+	{
+		TextureOptions options = image.Target->Options;
+		options.Channels = image.Channels;
+		image.Staging = std::make_unique<Texture>(image.Width, image.Height, nullptr, options);
+	}
+
+	const unsigned int dataFormat = Texture::GetDataFormat(image.Channels);
+	const size_t rowSize = (size_t)image.Width * image.Channels;
+	const int rows = std::min(image.Height - image.RowsUploaded, (int)std::max<size_t>(1, PixelBufferSize / rowSize));
+	const size_t size = rowSize * rows;
+
+	//Rotating through several buffers means we never write to one the GPU is still reading from
+	unsigned int pixelBuffer = m_PixelBuffers[m_NextPixelBuffer];
+	m_NextPixelBuffer = (m_NextPixelBuffer + 1) % PixelBufferCount;
+
+	GLCall(glBindBuffer(GL_PIXEL_UNPACK_BUFFER, pixelBuffer));
+	GLCall(glBufferData(GL_PIXEL_UNPACK_BUFFER, std::max(size, PixelBufferSize), nullptr, GL_STREAM_DRAW));
+	GLCall(void* mapped = glMapBufferRange(GL_PIXEL_UNPACK_BUFFER, 0, size, GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_BUFFER_BIT | GL_MAP_UNSYNCHRONIZED_BIT));
+	if (mapped)
+	{
+		memcpy(mapped, image.Pixels + rowSize * image.RowsUploaded, size);
+		GLCall(glUnmapBuffer(GL_PIXEL_UNPACK_BUFFER));
+
+		GLCall(glBindTexture(GL_TEXTURE_2D, image.Staging->GetRendererID()));
+		Texture::SetUnpackAlignment(rowSize);
+		GLCall(glTexSubImage2D(GL_TEXTURE_2D, 0, 0, image.RowsUploaded, image.Width, rows, dataFormat, GL_UNSIGNED_BYTE, nullptr));
+		RenderStats::Current().TextureBytesUploaded += size;
+		GLCall(glBindTexture(GL_TEXTURE_2D, 0));
+	}
+	GLCall(glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0));
+	GLCall(glPixelStorei(GL_UNPACK_ALIGNMENT, 4));
+
+	image.RowsUploaded += rows;
+	if (image.RowsUploaded < image.Height)
+		return false;
+
+	//The levels below 0 only add a third on top, so they go straight up once the base level is in
+	if (image.Target->Options.Mipmaps == TextureMipmaps::CPU)
+	{
+		GLCall(glBindTexture(GL_TEXTURE_2D, image.Staging->GetRendererID()));
+		const auto& levels = image.Mips.GetLevels();
+		for (unsigned int i = 0; i < levels.size(); i++)
+		{
+			Texture::SetUnpackAlignment((size_t)levels[i].Width * image.Channels);
+			GLCall(glTexSubImage2D(GL_TEXTURE_2D, i + 1, 0, 0, levels[i].Width, levels[i].Height, dataFormat, GL_UNSIGNED_BYTE, levels[i].Pixels.data()));
+			RenderStats::Current().TextureBytesUploaded += levels[i].Pixels.size();
+		}
+		GLCall(glPixelStorei(GL_UNPACK_ALIGNMENT, 4));
+		GLCall(glBindTexture(GL_TEXTURE_2D, 0));
+	}
+	else
+		image.Staging->GenerateMipmaps();
+
+	image.Target->Resident = std::move(image.Staging);
+	image.Target->Loading = false;
+	return true;
+}
+
+unsigned int TextureLoader::GetPendingCount()
+{
+	std::lock_guard<std::mutex> lock(m_Mutex);
+	return (unsigned int)(m_Requests.size() + m_Decoded.size()) + (m_Uploading ? 1 : 0);
+}
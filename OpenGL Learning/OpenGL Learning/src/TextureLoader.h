@@ -0,0 +1,105 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "Texture.h"
+#include "MipChain.h"
+#include "BlockCompression.h"
+
+//Returned by TextureLoader::Load, binds the loader's placeholder until the real texture has been uploaded
+class TextureHandle
+{
+private:
+	friend class TextureLoader;
+	friend class TextureCache;
+
+	struct Entry
+	{
+		std::string FilePath;
+		TextureOptions Options;
+		std::unique_ptr<Texture> Resident; //Only set and read on the GL thread
+		std::atomic<bool> Loading{ false }; //Queued, decoding or uploading
+		std::atomic<bool> Failed{ false }; //The last load couldn't read the file, so it isn't retried on every bind
+		bool Bound = false; //Set by Bind so a TextureCache can tell what was used this frame
+	};
+
+	std::shared_ptr<Entry> m_Entry;
+	const Texture* m_Placeholder;
+
+public:
+	TextureHandle()
+		: m_Placeholder(nullptr) {}
+
+	void Bind(unsigned int slot = 0) const;
+
+	inline bool IsResident() const { return m_Entry && m_Entry->Resident; }
+	//The uploaded texture, or null while it is still loading
+	inline const Texture* Get() const { return m_Entry ? m_Entry->Resident.get() : nullptr; }
+
+private:
+	TextureHandle(const std::shared_ptr<Entry>& entry, const Texture* placeholder)
+		: m_Entry(entry), m_Placeholder(placeholder) {}
+};
+
+//Decodes images on a pool of worker threads and uploads them on the GL thread through a ring of
+//pixel buffer objects. Update has to be called once per frame and only spends its time budget uploading,
+//so loading hundreds of images never stalls a frame for long. The loader must outlive its handles.
+class TextureLoader
+{
+private:
+	struct DecodedImage
+	{
+		std::shared_ptr<TextureHandle::Entry> Target;
+		unsigned char* Pixels;
+		int Width, Height, Channels;
+		int RowsUploaded;
+		MipChain Mips; //Built on the worker when the options ask for CPU mipmaps
+		std::unique_ptr<Texture> Staging; //Allocated on the first strip, handed to the entry once every row is in
+		std::unique_ptr<CompressedImage> Compressed; //Set instead of Pixels for .dds and .ktx2 files
+	};
+
+	static const int PixelBufferCount = 3;
+	static const size_t PixelBufferSize = 4 * 1024 * 1024; //Big images are uploaded in strips of rows that fit in this
+
+	std::vector<std::thread> m_Workers;
+	std::mutex m_Mutex;
+	std::condition_variable m_Condition;
+	std::deque<std::shared_ptr<TextureHandle::Entry>> m_Requests;
+	std::deque<DecodedImage> m_Decoded;
+	bool m_Running;
+
+	//Only touched by the GL thread
+	std::unique_ptr<Texture> m_Placeholder;
+	unsigned int m_PixelBuffers[PixelBufferCount];
+	int m_NextPixelBuffer;
+	std::unique_ptr<DecodedImage> m_Uploading;
+
+public:
+	//A thread count of 0 uses one worker per core, minus the render thread
+	TextureLoader(unsigned int threadCount = 0);
+	~TextureLoader();
+
+	TextureHandle Load(const std::string& path, const TextureOptions& options = TextureOptions());
+
+	//Uploads decoded images until budgetMs has been spent
+	void Update(float budgetMs = 2.0f);
+
+	//How many images are still being decoded or uploaded
+	unsigned int GetPendingCount();
+
+private:
+	friend class TextureCache;
+
+	//Queues an entry for loading, also used to bring back textures a TextureCache has evicted
+	void Queue(const std::shared_ptr<TextureHandle::Entry>& entry);
+	void WorkerLoop();
+	//Uploads the next strip of rows, returns true once the whole image is resident
+	bool UploadRows(DecodedImage& image);
+};
@@ -0,0 +1,276 @@
+#include "TilePyramid.h"
+#include "MipChain.h"
+#include "ImageDecoder.h"
+#include "PngDecoder.h"
+#include "Texture.h"
+#include "Log.h"
+
+#include <algorithm>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <memory>
+
+namespace {
+
+struct PyramidHeader
+{
+	char Magic[4];
+	uint32_t Version;
+	uint32_t Width, Height, TileSize, LevelCount;
+	int64_t SourceWriteTime;
+};
+
+struct PyramidLevel
+{
+	uint32_t Width, Height, TilesX, TilesY;
+	uint64_t Offset;
+};
+
+const uint32_t PyramidVersion = 2; //2 premultiplies alpha to match the global blend mode
+
+int64_t GetWriteTime(const std::string& path)
+{
+	std::error_code error;
+	auto time = std::filesystem::last_write_time(path, error);
+	return error ? 0 : (int64_t)time.time_since_epoch().count();
+}
+
+size_t GetTileStride(int tileSize)
+{
+	return (size_t)(tileSize + 2) * (tileSize + 2) * 4;
+}
+
+//One level of a pyramid being built. Rows come in top row first, the order files decode in, and only the band
+//of tiles being filled is held, its rows and the border row either side. Every row also goes into the last three
+//the next level's filter reads from, so all the levels fill together and none is ever held whole
+struct LevelBuilder
+{
+	PyramidLevel Info;
+	int TileSize;
+	std::ofstream& Stream;
+	int BandY; //The tile row being filled, the top one first
+	std::vector<unsigned char> Band, Recent, NextRow, Tile;
+	std::unique_ptr<MipChain::RowFilter> Filter;
+	LevelBuilder* Next;
+
+	LevelBuilder(const PyramidLevel& info, int tileSize, std::ofstream& stream)
+		: Info(info), TileSize(tileSize), Stream(stream), BandY((int)info.TilesY - 1), Next(nullptr)
+	{
+		Band.resize((size_t)(tileSize + 2) * info.Width * 4);
+		Tile.resize(GetTileStride(tileSize));
+	}
+
+	void SetNext(LevelBuilder* next)
+	{
+		Next = next;
+		Filter = std::make_unique<MipChain::RowFilter>(Info.Width, 4);
+		Recent.resize((size_t)3 * Info.Width * 4);
+		NextRow.resize((size_t)next->Info.Width * 4);
+	}
+
+	void Push(int y, const unsigned char* row)
+	{
+		//Padded row 0 is the border row below the band, texels past the edge of the image repeat the last row
+		const size_t rowSize = (size_t)Info.Width * 4;
+		const int bottom = BandY * TileSize - 1;
+		for (int p = 0; p < TileSize + 2; p++)
+		{
+			if (std::min(std::max(bottom + p, 0), (int)Info.Height - 1) == y)
+				memcpy(&Band[p * rowSize], row, rowSize);
+		}
+
+		if (y == std::max(bottom, 0))
+		{
+			WriteBand();
+
+			//The band's bottom two rows are the top border and top row of the one below it
+			memcpy(&Band[(TileSize + 1) * rowSize], &Band[rowSize], rowSize);
+			memcpy(&Band[TileSize * rowSize], &Band[0], rowSize);
+			BandY--;
+		}
+
+		if (Next)
+		{
+			memcpy(&Recent[(y % 3) * rowSize], row, rowSize);
+			const int nextY = y / 2;
+			if (y % 2 == 0 && nextY < (int)Next->Info.Height)
+			{
+				//Row y is the first the next level's row needs, the ones above it have already come in
+				const MipChain::Taps taps = MipChain::GetTaps(nextY, Info.Height);
+				const unsigned char* rows[3];
+				for (int k = 0; k < taps.Count; k++)
+					rows[k] = &Recent[((taps.First + k) % 3) * rowSize];
+				Filter->Filter(taps, rows, NextRow.data());
+				Next->Push(nextY, NextRow.data());
+			}
+		}
+	}
+
+	void WriteBand()
+	{
+		const int paddedSize = TileSize + 2;
+		const size_t rowSize = (size_t)Info.Width * 4;
+		Stream.seekp(Info.Offset + (uint64_t)BandY * Info.TilesX * Tile.size());
+		for (uint32_t tx = 0; tx < Info.TilesX; tx++)
+		{
+			for (int y = 0; y < paddedSize; y++)
+			{
+				const unsigned char* source = &Band[y * rowSize];
+				for (int x = 0; x < paddedSize; x++)
+				{
+					int sx = std::min(std::max((int)(tx * TileSize) + x - 1, 0), (int)Info.Width - 1);
+					memcpy(&Tile[((size_t)y * paddedSize + x) * 4], source + (size_t)sx * 4, 4);
+				}
+			}
+			Stream.write((const char*)Tile.data(), Tile.size());
+		}
+	}
+};
+
+}
+
+bool TilePyramid::Build(const std::string& imagePath, const std::string& pyramidPath, int tileSize)
+{
+	{
+		std::ifstream existing(pyramidPath, std::ios::binary);
+		PyramidHeader header;
+		if (existing && existing.read((char*)&header, sizeof(header)) && std::string(header.Magic, 4) == "TILE" &&
+			header.Version == PyramidVersion && header.TileSize == (uint32_t)tileSize && header.SourceWriteTime == GetWriteTime(imagePath))
+			return true;
+	}
+
+	//PNGs are decoded a row at a time as the tiles are cut, anything else has to be decoded whole first
+	MappedFile file(imagePath);
+	int width, height, bpp;
+	unsigned char* pixels = nullptr;
+	const bool streamed = file.IsOpen() && GetPngInfo(file.GetData(), file.GetSize(), &width, &height, nullptr, nullptr);
+	if (!streamed)
+	{
+		pixels = DecodeImageFile(imagePath, width, height, bpp, 4);
+		if (!pixels)
+		{
+			Log::Error("Failed to load {}: {}", imagePath, GetImageFailureReason());
+			return false;
+		}
+	}
+
+	//Levels stop once the whole image fits in a single tile
+	std::vector<PyramidLevel> table;
+	int levelWidth = width, levelHeight = height;
+	while (true)
+	{
+		PyramidLevel level = { (uint32_t)levelWidth, (uint32_t)levelHeight,
+			(uint32_t)((levelWidth + tileSize - 1) / tileSize), (uint32_t)((levelHeight + tileSize - 1) / tileSize), 0 };
+		table.push_back(level);
+		if (levelWidth <= tileSize && levelHeight <= tileSize)
+			break;
+
+		levelWidth = std::max(1, levelWidth / 2);
+		levelHeight = std::max(1, levelHeight / 2);
+	}
+
+	uint64_t offset = sizeof(PyramidHeader) + table.size() * sizeof(PyramidLevel);
+	for (auto& level : table)
+	{
+		level.Offset = offset;
+		offset += (uint64_t)level.TilesX * level.TilesY * GetTileStride(tileSize);
+	}
+
+	//Tiles are written wherever their band lands, the header goes in last so a build that fails part way is never
+	//mistaken for a finished one
+	std::ofstream stream(pyramidPath, std::ios::binary | std::ios::trunc);
+	PyramidHeader header = {};
+	stream.write((const char*)&header, sizeof(header));
+	stream.write((const char*)table.data(), table.size() * sizeof(PyramidLevel));
+
+	std::vector<LevelBuilder> levels;
+	levels.reserve(table.size());
+	for (const auto& level : table)
+		levels.emplace_back(level, tileSize, stream);
+	for (size_t i = 0; i + 1 < levels.size(); i++)
+		levels[i].SetNext(&levels[i + 1]);
+
+	//Tiles are drawn with premultiplied blending, so alpha is premultiplied before filtering like Texture does
+	bool decoded = true;
+	if (streamed)
+	{
+		const char* error = "";
+		std::vector<unsigned char> premultiplied((size_t)width * 4);
+		decoded = DecodePngRows(file.GetData(), file.GetSize(), 4, [&](int y, const unsigned char* row)
+		{
+			memcpy(premultiplied.data(), row, premultiplied.size());
+			Texture::PremultiplyAlpha(premultiplied.data(), width, 4);
+			levels[0].Push(height - 1 - y, premultiplied.data());
+		}, &error);
+		if (!decoded)
+			Log::Error("Failed to load {}: {}", imagePath, error);
+	}
+	else
+	{
+		Texture::PremultiplyAlpha(pixels, (size_t)width * height, 4);
+		for (int y = height - 1; y >= 0; y--)
+			levels[0].Push(y, pixels + (size_t)y * width * 4);
+		FreeImagePixels(pixels);
+	}
+
+	if (decoded)
+	{
+		header = { { 'T', 'I', 'L', 'E' }, PyramidVersion, (uint32_t)width, (uint32_t)height, (uint32_t)tileSize,
+			(uint32_t)table.size(), GetWriteTime(imagePath) };
+		stream.seekp(0);
+		stream.write((const char*)&header, sizeof(header));
+	}
+	if (!decoded || !stream)
+	{
+		if (decoded)
+			Log::Error("Failed to write {}!", pyramidPath);
+		stream.close();
+		std::error_code error;
+		std::filesystem::remove(pyramidPath, error);
+		return false;
+	}
+	return true;
+}
+
+TilePyramid::TilePyramid(const std::string& path)
+	: m_Width(0), m_Height(0), m_TileSize(0)
+{
+	if (!m_File.Open(path) || !ReadHeader())
+	{
+		Log::Error("{} isn't a valid tile pyramid!", path);
+		m_Levels.clear();
+	}
+}
+
+bool TilePyramid::ReadHeader()
+{
+	if (m_File.GetSize() < sizeof(PyramidHeader))
+		return false;
+
+	PyramidHeader header;
+	memcpy(&header, m_File.GetData(), sizeof(header));
+	if (std::string(header.Magic, 4) != "TILE" || header.Version != PyramidVersion || header.LevelCount == 0 ||
+		m_File.GetSize() < sizeof(header) + header.LevelCount * sizeof(PyramidLevel))
+		return false;
+
+	m_Width = header.Width;
+	m_Height = header.Height;
+	m_TileSize = header.TileSize;
+	for (uint32_t i = 0; i < header.LevelCount; i++)
+	{
+		PyramidLevel level;
+		memcpy(&level, m_File.GetData() + sizeof(header) + i * sizeof(PyramidLevel), sizeof(level));
+		if (level.Offset + (uint64_t)level.TilesX * level.TilesY * GetTileStride(m_TileSize) > m_File.GetSize())
+			return false;
+
+		m_Levels.push_back({ (int)level.Width, (int)level.Height, (int)level.TilesX, (int)level.TilesY, level.Offset });
+	}
+	return true;
+}
+
+const unsigned char* TilePyramid::GetTile(int level, int x, int y) const
+{
+	const Level& info = m_Levels[level];
+	return m_File.GetData() + info.Offset + ((size_t)y * info.TilesX + x) * GetTileStride(m_TileSize);
+}
@@ -0,0 +1,50 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "MappedFile.h"
+
+//An image cut into fixed size RGBA8 tiles at every mip level, stored in one memory mapped file so any tile
+//can be read without loading the rest. Alpha is premultiplied to suit the renderer's blend mode. Each tile has
+//a one texel border copied from its neighbours so tiles placed anywhere in a cache texture still filter without
+//seams. Level n halves level n-1 and the last level fits in a single tile, tile (x, y) of level n covers tiles
+//(2x, 2y) to (2x+1, 2y+1) of level n-1.
+class TilePyramid
+{
+public:
+	struct Level
+	{
+		int Width, Height;
+		int TilesX, TilesY;
+		uint64_t Offset; //Of the first tile in the file
+	};
+
+private:
+	MappedFile m_File;
+	std::vector<Level> m_Levels;
+	int m_Width, m_Height, m_TileSize;
+
+public:
+	TilePyramid(const std::string& path);
+
+	//Cuts an image into a pyramid file. PNGs are decoded, filtered and cut a band of rows at a time so only a few
+	//tile rows per level are ever in memory, other formats are decoded whole first. Reading it afterwards only ever
+	//touches the tiles that are asked for. Skipped if the pyramid is newer than the source
+	static bool Build(const std::string& imagePath, const std::string& pyramidPath, int tileSize = 256);
+
+	//The padded tile, GetPaddedSize() squared RGBA8 texels with the bottom row first
+	const unsigned char* GetTile(int level, int x, int y) const;
+
+	inline bool IsOpen() const { return m_File.IsOpen() && !m_Levels.empty(); }
+	inline const Level& GetLevel(int level) const { return m_Levels[level]; }
+	inline int GetLevelCount() const { return (int)m_Levels.size(); }
+	inline int GetWidth() const { return m_Width; }
+	inline int GetHeight() const { return m_Height; }
+	inline int GetTileSize() const { return m_TileSize; }
+	inline int GetPaddedSize() const { return m_TileSize + 2; }
+
+private:
+	bool ReadHeader();
+};
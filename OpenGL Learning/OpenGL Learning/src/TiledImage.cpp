@@ -0,0 +1,176 @@
+#include "TiledImage.h"
+#include "VertexBufferLayout.h"
+#include "RenderStats.h"
+
+#include <algorithm>
+#include <cmath>
+
+TiledImage::TiledImage(const std::string& pyramidPath, int cacheSize)
+	: m_Pyramid(pyramidPath), m_TileSize(m_Pyramid.GetTileSize()), m_CacheSize(cacheSize), m_SlotsPerRow(0), m_Frame(0)
+{
+	if (!IsOpen())
+		return;
+
+	m_Cache = std::make_unique<Texture>(cacheSize, cacheSize);
+	m_SlotsPerRow = cacheSize / (m_TileSize + 2);
+	m_Slots.assign((size_t)m_SlotsPerRow * m_SlotsPerRow, { InvalidKey, 0 });
+
+	//Quads are rebuilt every frame, only the index pattern stays the same
+	m_VertexArray = std::make_unique<VertexArray>();
+	m_VertexBuffer = std::make_unique<VertexBuffer>(MaxQuads * 4 * (unsigned int)sizeof(Vertex));
+	VertexBufferLayout layout;
+	layout.Push<float>(2);
+	layout.Push<float>(2);
+	m_VertexArray->AddBuffer(*m_VertexBuffer, layout);
+
+	std::vector<unsigned int> indices(MaxQuads * 6);
+	for (unsigned int i = 0; i < MaxQuads; i++)
+	{
+		const unsigned int quad[6] = { 0, 1, 2, 2, 3, 0 };
+		for (int j = 0; j < 6; j++)
+			indices[i * 6 + j] = i * 4 + quad[j];
+	}
+	m_IndexBuffer = std::make_unique<IndexBuffer>(indices.data(), MaxQuads * 6);
+	m_VertexArray->UnBind();
+}
+
+void TiledImage::Update(const glm::vec4& visibleRect, float pixelsPerScreenPixel, unsigned int uploadBudget)
+{
+	m_Frame++;
+	m_Vertices.clear();
+	if (!IsOpen())
+		return;
+
+	const int topLevel = (int)m_Pyramid.GetLevelCount() - 1;
+	int level = pixelsPerScreenPixel > 1.0f ? (int)std::floor(std::log2(pixelsPerScreenPixel)) : 0;
+	level = std::min(level, topLevel);
+
+	//The single tile at the top is what everything falls back to, so it is always kept
+	RequestTile(topLevel, 0, 0, uploadBudget);
+
+	const TilePyramid::Level& info = m_Pyramid.GetLevel(level);
+	const float span = (float)(m_TileSize << level);
+	const int x0 = std::max(0, (int)std::floor(visibleRect.x / span)), x1 = std::min(info.TilesX - 1, (int)std::floor(visibleRect.z / span));
+	const int y0 = std::max(0, (int)std::floor(visibleRect.y / span)), y1 = std::min(info.TilesY - 1, (int)std::floor(visibleRect.w / span));
+
+	for (int y = y0; y <= y1; y++)
+	{
+		for (int x = x0; x <= x1; x++)
+		{
+			const glm::vec4 rect = GetTileRect(level, x, y);
+			int slot = RequestTile(level, x, y, uploadBudget);
+			if (slot >= 0)
+			{
+				AddQuad(rect, level, x, y, slot);
+				continue;
+			}
+
+			//Stretch the closest coarser tile that is already in the cache over the gap
+			for (int parent = level + 1; parent <= topLevel; parent++)
+			{
+				const int px = x >> (parent - level), py = y >> (parent - level);
+				auto it = m_SlotLookup.find(MakeKey(parent, px, py));
+				if (it != m_SlotLookup.end())
+				{
+					m_Slots[it->second].LastUsedFrame = m_Frame;
+					AddQuad(rect, parent, px, py, it->second);
+					break;
+				}
+			}
+		}
+	}
+
+	if (!m_Vertices.empty())
+		m_VertexBuffer->SetData(m_Vertices.data(), (unsigned int)(m_Vertices.size() * sizeof(Vertex)));
+}
+
+int TiledImage::RequestTile(int level, int x, int y, unsigned int& uploadBudget)
+{
+	const uint64_t key = MakeKey(level, x, y);
+	auto it = m_SlotLookup.find(key);
+	if (it != m_SlotLookup.end())
+	{
+		m_Slots[it->second].LastUsedFrame = m_Frame;
+		return it->second;
+	}
+
+	if (uploadBudget == 0)
+		return -1;
+
+	//An empty slot, otherwise the one used longest ago that isn't on screen this frame
+	int slot = -1;
+	for (int i = 0; i < (int)m_Slots.size(); i++)
+	{
+		if (m_Slots[i].Key == InvalidKey)
+		{
+			slot = i;
+			break;
+		}
+		if (m_Slots[i].LastUsedFrame != m_Frame && (slot < 0 || m_Slots[i].LastUsedFrame < m_Slots[slot].LastUsedFrame))
+			slot = i;
+	}
+	if (slot < 0)
+		return -1;
+
+	if (m_Slots[slot].Key != InvalidKey)
+		m_SlotLookup.erase(m_Slots[slot].Key);
+	m_Slots[slot] = { key, m_Frame };
+	m_SlotLookup[key] = slot;
+	uploadBudget--;
+
+	//Straight from the mapped file, the OS pages the tile in as the driver copies it
+	const unsigned char* tile = m_Pyramid.GetTile(level, x, y);
+	const int paddedSize = m_Pyramid.GetPaddedSize();
+	GLCall(glBindTexture(GL_TEXTURE_2D, m_Cache->GetRendererID()));
+	GLCall(glTexSubImage2D(GL_TEXTURE_2D, 0, (slot % m_SlotsPerRow) * paddedSize, (slot / m_SlotsPerRow) * paddedSize,
+		paddedSize, paddedSize, GL_RGBA, GL_UNSIGNED_BYTE, tile));
+	RenderStats::Current().TextureBytesUploaded += (size_t)paddedSize * paddedSize * 4;
+	GLCall(glBindTexture(GL_TEXTURE_2D, 0));
+	return slot;
+}
+
+glm::vec4 TiledImage::GetTileRect(int level, int x, int y) const
+{
+	const TilePyramid::Level& info = m_Pyramid.GetLevel(level);
+	const int width = std::min(m_TileSize, info.Width - x * m_TileSize);
+	const int height = std::min(m_TileSize, info.Height - y * m_TileSize);
+	return glm::vec4(
+		(float)((x * m_TileSize) << level), (float)((y * m_TileSize) << level),
+		(float)std::min((x * m_TileSize + width) << level, m_Pyramid.GetWidth()), (float)std::min((y * m_TileSize + height) << level, m_Pyramid.GetHeight()));
+}
+
+void TiledImage::AddQuad(const glm::vec4& rect, int level, int x, int y, int slot)
+{
+	if (m_Vertices.size() >= MaxQuads * 4)
+		return;
+
+	//Maps rect, which can be part of the tile when it stands in for a finer one, onto the tile's slot
+	const TilePyramid::Level& info = m_Pyramid.GetLevel(level);
+	const glm::vec4 tileRect = GetTileRect(level, x, y);
+	const int paddedSize = m_TileSize + 2;
+	const glm::vec2 origin((float)((slot % m_SlotsPerRow) * paddedSize + 1), (float)((slot / m_SlotsPerRow) * paddedSize + 1));
+	const glm::vec2 size((float)std::min(m_TileSize, info.Width - x * m_TileSize), (float)std::min(m_TileSize, info.Height - y * m_TileSize));
+
+	auto texCoord = [&](float px, float py)
+	{
+		glm::vec2 t((px - tileRect.x) / (tileRect.z - tileRect.x), (py - tileRect.y) / (tileRect.w - tileRect.y));
+		return (origin + t * size) / (float)m_CacheSize;
+	};
+
+	m_Vertices.push_back({ glm::vec2(rect.x, rect.y), texCoord(rect.x, rect.y) });
+	m_Vertices.push_back({ glm::vec2(rect.z, rect.y), texCoord(rect.z, rect.y) });
+	m_Vertices.push_back({ glm::vec2(rect.z, rect.w), texCoord(rect.z, rect.w) });
+	m_Vertices.push_back({ glm::vec2(rect.x, rect.w), texCoord(rect.x, rect.w) });
+}
+
+void TiledImage::Draw(const Renderer& renderer, Shader& shader, const glm::mat4& mvp) const
+{
+	if (m_Vertices.empty())
+		return;
+
+	shader.Bind();
+	shader.SetUniformMat4f("u_MVP", mvp);
+	shader.SetUniform1i("u_Texture", 0);
+	m_Cache->Bind(0);
+	renderer.Draw(*m_VertexArray, *m_IndexBuffer, shader, (unsigned int)(m_Vertices.size() / 4) * 6);
+}
@@ -0,0 +1,74 @@
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "glm/glm.hpp"
+#include "TilePyramid.h"
+#include "Renderer.h"
+#include "Texture.h"
+#include "VertexArray.h"
+#include "VertexBuffer.h"
+#include "IndexBuffer.h"
+
+//Views images too big for a single texture, or for video memory. The image is cut once into a TilePyramid
+//on disk and Update only uploads the tiles visible at the current zoom into slots of one cache texture.
+//Tiles that haven't arrived yet are drawn from a coarser level.
+//Positions are in pixels of the full size image with the origin at its bottom left.
+class TiledImage
+{
+private:
+	struct Slot
+	{
+		uint64_t Key; //Level, tile x and tile y packed together, InvalidKey when empty
+		unsigned int LastUsedFrame;
+	};
+
+	struct Vertex
+	{
+		glm::vec2 Position;
+		glm::vec2 TexCoord;
+	};
+
+	static const uint64_t InvalidKey = ~0ull;
+	static const unsigned int MaxQuads = 4096;
+
+	TilePyramid m_Pyramid;
+	int m_TileSize;
+
+	std::unique_ptr<Texture> m_Cache;
+	int m_CacheSize, m_SlotsPerRow;
+	std::vector<Slot> m_Slots;
+	std::unordered_map<uint64_t, int> m_SlotLookup;
+	unsigned int m_Frame;
+
+	std::unique_ptr<VertexArray> m_VertexArray;
+	std::unique_ptr<VertexBuffer> m_VertexBuffer;
+	std::unique_ptr<IndexBuffer> m_IndexBuffer;
+	std::vector<Vertex> m_Vertices;
+
+public:
+	//cacheSize is the width and height of the cache texture, 4096 holds 225 tiles of 256 in 64MB
+	TiledImage(const std::string& pyramidPath, int cacheSize = 4096);
+
+	//visibleRect is the part of the image on screen as min x, min y, max x, max y and pixelsPerScreenPixel
+	//how many image pixels cover one on screen, which picks the level. Uploads at most uploadBudget tiles
+	void Update(const glm::vec4& visibleRect, float pixelsPerScreenPixel, unsigned int uploadBudget = 8);
+	//Uses a shader with the Basic shader's inputs, u_MVP and u_Texture
+	void Draw(const Renderer& renderer, Shader& shader, const glm::mat4& mvp) const;
+
+	inline bool IsOpen() const { return m_Pyramid.IsOpen(); }
+	inline int GetWidth() const { return m_Pyramid.GetWidth(); }
+	inline int GetHeight() const { return m_Pyramid.GetHeight(); }
+	inline int GetLevelCount() const { return m_Pyramid.GetLevelCount(); }
+
+private:
+	int RequestTile(int level, int x, int y, unsigned int& uploadBudget);
+	void AddQuad(const glm::vec4& rect, int level, int x, int y, int slot);
+	glm::vec4 GetTileRect(int level, int x, int y) const;
+
+	static inline uint64_t MakeKey(int level, int x, int y) { return ((uint64_t)level << 48) | ((uint64_t)y << 24) | (uint64_t)x; }
+};
@@ -1,6 +1,7 @@
 #include "VertexArray.h"
 #include "VertexBufferLayout.h"
 #include "Renderer.h"
+#include "RenderStats.h"
 
 VertexArray::VertexArray()
 {
@@ -21,8 +22,9 @@ void VertexArray::AddBuffer(const VertexBuffer& vb, const VertexBufferLayout& la
 	for(unsigned int i = 0; i< elements.size(); i++)
 	{
 		const auto& element = elements[i];
-		GLCall(glEnableVertexAttribArray(i)); //Enables the Vertex attributes array
-		GLCall(glVertexAttribPointer(i, element.count, element.type, element.normalized, layout.GetStride(), (const void*)offset)); //This says that the Vertices are 2 floats for each vertex
+		GLCall(glEnableVertexAttribArray(element.location)); //Enables the Vertex attributes array
+		GLCall(glVertexAttribPointer(element.location, element.count, element.type, element.normalized, layout.GetStride(), (const void*)offset)); //This says that the Vertices are 2 floats for each vertex
+		GLCall(glVertexAttribDivisor(element.location, layout.GetDivisor()));
 
 		offset += element.count * VertexBufferElement::GetSizeOfType(element.type);
 		
@@ -31,10 +33,11 @@ void VertexArray::AddBuffer(const VertexBuffer& vb, const VertexBufferLayout& la
 
 void VertexArray::Bind() const
 {
-	GLCall(glBindVertexArray(m_RendererID))
+	RenderStats::Current().VertexArrayBinds++;
+	GLCall(glBindVertexArray(m_RendererID));
 }
 
 void VertexArray::UnBind() const
 {
-		GLCall(glBindVertexArray(0))
+		GLCall(glBindVertexArray(0));
 }
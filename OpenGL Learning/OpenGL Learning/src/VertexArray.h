@@ -12,9 +12,10 @@ public:
 	VertexArray();
 	~VertexArray();
 
+	//Every element is enabled, even ones the shader doesn't read yet, so a hot reloaded shader that starts reading
+	//one still finds it. VertexBufferLayout::Validate reports mismatches
 	void AddBuffer(const VertexBuffer& vb, const VertexBufferLayout& layout);
 
 	void Bind() const;
 	void UnBind() const;
-	
 };
\ No newline at end of file
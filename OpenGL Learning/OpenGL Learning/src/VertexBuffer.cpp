@@ -1,14 +1,26 @@
 #include "VertexBuffer.h"
 #include "Renderer.h"
+#include "RenderStats.h"
 
 VertexBuffer::VertexBuffer(const void* data, unsigned size)
 {
 	GLCall(glGenBuffers(1, &m_RendererID)); //This generates a buffer that the GPU can use to draw to the screen
 	GLCall(glBindBuffer(GL_ARRAY_BUFFER, m_RendererID)); //This Selects the buffer that we just created	
 	GLCall(glBufferData(GL_ARRAY_BUFFER, size, data, GL_STATIC_DRAW)); //This added the data to the buffer as STATIC meaning that the data won't change but can be called multiple times
+	RenderStats::Current().BuffersCreated++;
+	if (data)
+		RenderStats::Current().BufferBytesUploaded += size;
 
 }
 
+VertexBuffer::VertexBuffer(unsigned int size)
+{
+	GLCall(glGenBuffers(1, &m_RendererID));
+	GLCall(glBindBuffer(GL_ARRAY_BUFFER, m_RendererID));
+	GLCall(glBufferData(GL_ARRAY_BUFFER, size, nullptr, GL_DYNAMIC_DRAW)); //DYNAMIC as the contents are replaced often
+	RenderStats::Current().BuffersCreated++;
+}
+
 VertexBuffer::~VertexBuffer()
 {
 	GLCall(glDeleteBuffers(1, &m_RendererID));
@@ -22,4 +34,11 @@ void VertexBuffer::Bind() const
 void VertexBuffer::UnBind() const
 {
 	GLCall(glBindBuffer(GL_ARRAY_BUFFER, 0));
+}
+
+void VertexBuffer::SetData(const void* data, unsigned int size, unsigned int offset)
+{
+	GLCall(glBindBuffer(GL_ARRAY_BUFFER, m_RendererID));
+	GLCall(glBufferSubData(GL_ARRAY_BUFFER, offset, size, data));
+	RenderStats::Current().BufferBytesUploaded += size;
 }
\ No newline at end of file
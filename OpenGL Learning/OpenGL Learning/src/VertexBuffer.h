@@ -7,8 +7,14 @@ private:
 
 public:
 	VertexBuffer(const void* data, unsigned int size);
+	//Leaves size bytes of storage empty to be filled with SetData every frame
+	VertexBuffer(unsigned int size);
 	~VertexBuffer();
 
 	void Bind() const;
 	void UnBind() const;
+
+	void SetData(const void* data, unsigned int size, unsigned int offset = 0);
+
+	inline unsigned int GetRendererID() const { return m_RendererID; }
 };
\ No newline at end of file
@@ -0,0 +1,69 @@
+#include "VertexBufferLayout.h"
+#include "Log.h"
+
+VertexBufferLayout VertexBufferLayout::FromShader(const Shader& shader)
+{
+	VertexBufferLayout layout;
+	for (const auto& attribute : shader.GetAttributes())
+	{
+		if (attribute.GetComponentType() != GL_FLOAT)
+		{
+			Log::Warning("Warning: Attribute {} isn't a float input, it will be fed as floats!", attribute.Name);
+		}
+
+		//Matrices and arrays take one location per column or element
+		for (unsigned int i = 0; i < attribute.GetLocationCount(); i++)
+		{
+			unsigned int count = attribute.GetComponentCount();
+			layout.m_Elements.push_back({GL_FLOAT, count, GL_FALSE, attribute.Location + i});
+			layout.m_Stride += count * VertexBufferElement::GetSizeOfType(GL_FLOAT);
+		}
+	}
+	return layout;
+}
+
+bool VertexBufferLayout::Validate(const Shader& shader) const
+{
+	bool valid = true;
+
+	for (const auto& element : m_Elements)
+	{
+		if (!shader.IsAttributeActive(element.location))
+		{
+			Log::Warning("Warning: Layout element at location {} isn't read by {}!", element.location, shader.GetFilePath());
+		}
+	}
+
+	for (const auto& attribute : shader.GetAttributes())
+	{
+		for (unsigned int i = 0; i < attribute.GetLocationCount(); i++)
+		{
+			unsigned int location = attribute.Location + i;
+
+			const VertexBufferElement* match = nullptr;
+			for (const auto& element : m_Elements)
+			{
+				if (element.location == location)
+					match = &element;
+			}
+
+			if (!match)
+			{
+				Log::Error("Error: Attribute {} at location {} isn't in the layout!", attribute.Name, location);
+				valid = false;
+			}
+			else if (attribute.GetComponentType() != GL_FLOAT)
+			{
+				//VertexArray::AddBuffer always uses glVertexAttribPointer so integer inputs would be read as garbage
+				Log::Error("Error: Attribute {} is an integer input but the layout feeds floats!", attribute.Name);
+				valid = false;
+			}
+			else if (match->count > attribute.GetComponentCount())
+			{
+				Log::Warning("Warning: Attribute {} reads {} components but the layout provides {}!", attribute.Name, attribute.GetComponentCount(), match->count);
+			}
+		}
+	}
+
+	return valid;
+}
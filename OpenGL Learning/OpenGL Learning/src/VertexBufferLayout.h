@@ -9,6 +9,7 @@ struct VertexBufferElement
 	unsigned int type;
 	unsigned int count;
 	unsigned char normalized;
+	unsigned int location;
 
 	static unsigned int GetSizeOfType(unsigned int type)
 	{
@@ -29,10 +30,13 @@ class VertexBufferLayout
 private:
 	std::vector<VertexBufferElement> m_Elements;
 	unsigned int m_Stride;
+	unsigned int m_Divisor;
+	unsigned int m_FirstLocation;
 	
 public:
-	VertexBufferLayout()
-		:m_Stride(0) {}
+	//A second buffer, like one with per instance data, starts after the locations used by the first
+	explicit VertexBufferLayout(unsigned int firstLocation = 0)
+		:m_Stride(0), m_Divisor(0), m_FirstLocation(firstLocation) {}
 
 	template<typename T>
 	void Push(unsigned int count)
@@ -43,24 +47,35 @@ public:
 	template<>
 	void Push<float>(unsigned int count)
 	{
-		m_Elements.push_back({GL_FLOAT, count, GL_FALSE});
+		m_Elements.push_back({GL_FLOAT, count, GL_FALSE, m_FirstLocation + (unsigned int)m_Elements.size()});
 		m_Stride += count * VertexBufferElement::GetSizeOfType(GL_FLOAT);
 	}
 
 	template<>
 	void Push<unsigned int>(unsigned int count)
 	{
-		m_Elements.push_back({GL_UNSIGNED_INT, count, GL_FALSE});
+		m_Elements.push_back({GL_UNSIGNED_INT, count, GL_FALSE, m_FirstLocation + (unsigned int)m_Elements.size()});
 		m_Stride += count * VertexBufferElement::GetSizeOfType(GL_UNSIGNED_INT);
 	}
 
 	template<>
 	void Push<unsigned char>(unsigned int count)
 	{
-		m_Elements.push_back({GL_UNSIGNED_BYTE, count, GL_TRUE});
+		m_Elements.push_back({GL_UNSIGNED_BYTE, count, GL_TRUE, m_FirstLocation + (unsigned int)m_Elements.size()});
 		m_Stride += count * VertexBufferElement::GetSizeOfType(GL_UNSIGNED_BYTE);
 	}
 
 	inline std::vector<VertexBufferElement> GetElements() const { return m_Elements; };
 	inline unsigned int GetStride() const { return m_Stride; }
+
+	//A divisor of 1 steps the whole buffer once per instance instead of once per vertex
+	inline void SetDivisor(unsigned int divisor) { m_Divisor = divisor; }
+	inline unsigned int GetDivisor() const { return m_Divisor; }
+
+	//Builds a tightly packed layout with one float element per location the shader reads
+	static VertexBufferLayout FromShader(const Shader& shader);
+
+	//Logs every element the shader doesn't read and every input the layout doesn't feed,
+	//returns false if the shader reads something the layout can't provide
+	bool Validate(const Shader& shader) const;
 };
\ No newline at end of file
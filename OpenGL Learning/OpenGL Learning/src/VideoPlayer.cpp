@@ -0,0 +1,135 @@
+#include "VideoPlayer.h"
+#include "Log.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+VideoPlayer::VideoPlayer(const std::string& path)
+	: m_Width(0), m_Height(0), m_ChromaWidth(0), m_ChromaHeight(0), m_FrameRate(25.0), m_Time(0.0), m_CurrentFrame(-1)
+{
+	if (!m_File.Open(path))
+	{
+		Log::Error("Failed to open video {}!", path);
+		return;
+	}
+	if (!ParseHeader(path))
+	{
+		m_File.Close();
+		return;
+	}
+
+	m_Planes = std::make_unique<DynamicTexture>(m_ChromaWidth * 2, m_Height + m_ChromaHeight, 1);
+}
+
+bool VideoPlayer::ParseHeader(const std::string& path)
+{
+	const char* data = (const char*)m_File.GetData();
+	const size_t size = m_File.GetSize();
+	const char* headerEnd = (const char*)memchr(data, '\n', size);
+	if (size < 10 || memcmp(data, "YUV4MPEG2 ", 10) != 0 || !headerEnd)
+	{
+		Log::Error("{} isn't a YUV4MPEG2 file!", path);
+		return false;
+	}
+
+	//Parameters are a letter followed by a value, separated by spaces
+	const std::string header(data + 10, headerEnd);
+	std::string colourSpace = "420jpeg";
+	size_t start = 0;
+	while (start < header.size())
+	{
+		size_t end = header.find(' ', start);
+		if (end == std::string::npos)
+			end = header.size();
+		const std::string parameter = header.substr(start, end - start);
+		start = end + 1;
+		if (parameter.empty())
+			continue;
+
+		if (parameter[0] == 'W')
+			m_Width = atoi(parameter.c_str() + 1);
+		else if (parameter[0] == 'H')
+			m_Height = atoi(parameter.c_str() + 1);
+		else if (parameter[0] == 'C')
+			colourSpace = parameter.substr(1);
+		else if (parameter[0] == 'F')
+		{
+			int numerator = 0, denominator = 0;
+			if (sscanf(parameter.c_str() + 1, "%d:%d", &numerator, &denominator) == 2 && numerator > 0 && denominator > 0)
+				m_FrameRate = (double)numerator / denominator;
+		}
+	}
+
+	if (m_Width <= 0 || m_Height <= 0)
+	{
+		Log::Error("{} has no frame size!", path);
+		return false;
+	}
+	if (colourSpace.compare(0, 3, "420") != 0)
+	{
+		Log::Error("{} is {}, only 4:2:0 videos can be played!", path, colourSpace);
+		return false;
+	}
+	m_ChromaWidth = (m_Width + 1) / 2;
+	m_ChromaHeight = (m_Height + 1) / 2;
+
+	//Every frame starts with its own FRAME line, which can carry parameters, so they are found once up front
+	const size_t frameSize = (size_t)m_Width * m_Height + 2 * (size_t)m_ChromaWidth * m_ChromaHeight;
+	size_t position = headerEnd - data + 1;
+	while (position + 5 <= size && memcmp(data + position, "FRAME", 5) == 0)
+	{
+		const char* lineEnd = (const char*)memchr(data + position, '\n', size - position);
+		if (!lineEnd)
+			break;
+		const size_t planes = lineEnd - data + 1;
+		if (planes + frameSize > size)
+			break;
+		m_FrameOffsets.push_back(planes);
+		position = planes + frameSize;
+	}
+
+	if (m_FrameOffsets.empty())
+	{
+		Log::Error("{} has no complete frames!", path);
+		return false;
+	}
+	return true;
+}
+
+void VideoPlayer::Update(float deltaSeconds)
+{
+	if (!m_Planes)
+		return;
+
+	m_Time = fmod(m_Time + deltaSeconds, GetFrameCount() / m_FrameRate);
+	const int frame = std::min((int)(m_Time * m_FrameRate), GetFrameCount() - 1);
+	if (frame == m_CurrentFrame)
+		return;
+
+	//If every buffer is still on its way to the GPU the old frame stays up and this one is tried again next time
+	if (!m_Planes->BeginUpdate())
+		return;
+
+	const unsigned char* y = m_File.GetData() + m_FrameOffsets[frame];
+	const unsigned char* u = y + (size_t)m_Width * m_Height;
+	const unsigned char* v = u + (size_t)m_ChromaWidth * m_ChromaHeight;
+	m_Planes->UpdateRegion(0, 0, m_Width, m_Height, y);
+	m_Planes->UpdateRegion(0, m_Height, m_ChromaWidth, m_ChromaHeight, u);
+	m_Planes->UpdateRegion(m_ChromaWidth, m_Height, m_ChromaWidth, m_ChromaHeight, v);
+	m_Planes->EndUpdate();
+	m_CurrentFrame = frame;
+}
+
+void VideoPlayer::Bind(Shader& shader, unsigned int slot) const
+{
+	if (!m_Planes)
+		return;
+
+	m_Planes->Bind(slot);
+	shader.Bind();
+	shader.SetUniform1i("u_Planes", slot);
+	shader.SetUniform2f("u_LumaSize", (float)m_Width, (float)m_Height);
+}
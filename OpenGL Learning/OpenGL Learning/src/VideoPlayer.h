@@ -0,0 +1,43 @@
+#pragma once
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "DynamicTexture.h"
+#include "MappedFile.h"
+#include "shader.h"
+
+//Plays an uncompressed .y4m video, looping, through a DynamicTexture. Only 4:2:0 files are supported. The three
+//planes are copied unconverted into one single channel texture, Y on top with U and V side by side below it,
+//and the Video shader turns them into RGB.
+class VideoPlayer
+{
+private:
+	MappedFile m_File;
+	std::vector<size_t> m_FrameOffsets; //Where each frame's Y plane starts in the file
+	int m_Width, m_Height, m_ChromaWidth, m_ChromaHeight;
+	double m_FrameRate;
+	double m_Time;
+	int m_CurrentFrame;
+	std::unique_ptr<DynamicTexture> m_Planes;
+
+public:
+	VideoPlayer(const std::string& path);
+
+	//Moves the playhead on and uploads the frame it lands on if that has changed
+	void Update(float deltaSeconds);
+
+	//Binds the planes and sets the Video shader's uniforms
+	void Bind(Shader& shader, unsigned int slot = 0) const;
+
+	inline bool IsOpen() const { return m_Planes != nullptr; }
+	inline int GetWidth() const { return m_Width; }
+	inline int GetHeight() const { return m_Height; }
+	inline int GetFrameCount() const { return (int)m_FrameOffsets.size(); }
+	inline int GetCurrentFrame() const { return m_CurrentFrame; }
+	inline double GetFrameRate() const { return m_FrameRate; }
+
+private:
+	bool ParseHeader(const std::string& path);
+};
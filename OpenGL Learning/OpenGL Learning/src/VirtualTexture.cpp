@@ -0,0 +1,339 @@
+#include "VirtualTexture.h"
+#include "CpuProfiler.h"
+#include "RenderStats.h"
+
+#include <algorithm>
+#include <climits>
+#include <cmath>
+#include <cstring>
+
+VirtualTexture::VirtualTexture(const std::string& pyramidPath, int cacheSize, int feedbackScale)
+	: m_Pyramid(pyramidPath), m_TileSize(m_Pyramid.GetTileSize()), m_CacheSize(cacheSize), m_SlotsPerRow(0),
+	m_Frame(0), m_FeedbackScale(std::max(1, feedbackScale)), m_FeedbackBuffers{ 0, 0 },
+	m_FeedbackSize{ { 0, 0 }, { 0, 0 } }, m_FeedbackIndex(0), m_BlendWasEnabled(false), m_ClearColour{ 0.0f, 0.0f, 0.0f, 0.0f },
+	m_Running(true)
+{
+	if (!IsOpen())
+		return;
+
+	//Slot coordinates are stored as bytes in the indirection texture
+	m_PageCache = std::make_unique<Texture>(cacheSize, cacheSize);
+	m_SlotsPerRow = std::min(256, cacheSize / m_Pyramid.GetPaddedSize());
+	m_Slots.assign((size_t)m_SlotsPerRow * m_SlotsPerRow, { InvalidKey, 0 });
+
+	const TilePyramid::Level& base = m_Pyramid.GetLevel(0);
+	m_Indirection = std::make_unique<Texture2DArray>(base.TilesX, base.TilesY, m_Pyramid.GetLevelCount());
+	m_IndirectionData.resize((size_t)base.TilesX * base.TilesY * 4 * m_Pyramid.GetLevelCount());
+
+	//The single page at the top is what everything falls back to, so it is loaded straight away and never evicted
+	const int topLevel = m_Pyramid.GetLevelCount() - 1;
+	UploadPage(MakeKey(topLevel, 0, 0), m_Pyramid.GetTile(topLevel, 0, 0), true);
+	UpdateIndirection();
+
+	GLCall(glGenBuffers(FeedbackBufferCount, m_FeedbackBuffers));
+	RenderStats::Current().BuffersCreated += FeedbackBufferCount;
+	m_Worker = std::thread(&VirtualTexture::WorkerLoop, this);
+}
+
+VirtualTexture::~VirtualTexture()
+{
+	{
+		std::lock_guard<std::mutex> lock(m_Mutex);
+		m_Running = false;
+	}
+	m_Condition.notify_all();
+	if (m_Worker.joinable())
+		m_Worker.join();
+
+	if (m_FeedbackBuffers[0])
+	{
+		GLCall(glDeleteBuffers(FeedbackBufferCount, m_FeedbackBuffers));
+	}
+}
+
+void VirtualTexture::BeginFeedback(Shader& feedbackShader, int viewWidth, int viewHeight)
+{
+	m_Frame++;
+	if (!IsOpen())
+		return;
+
+	const int width = std::max(1, viewWidth / m_FeedbackScale);
+	const int height = std::max(1, viewHeight / m_FeedbackScale);
+	if (!m_Feedback)
+		m_Feedback = std::make_unique<Framebuffer>(width, height, true);
+	m_Feedback->Resize(width, height);
+
+	//Alpha 0 marks pixels nothing virtual textured was drawn to, and blending would mix up the encoded pages
+	m_Feedback->Bind();
+	GLCall(glGetFloatv(GL_COLOR_CLEAR_VALUE, m_ClearColour));
+	GLCall(glClearColor(0.0f, 0.0f, 0.0f, 0.0f));
+	GLCall(glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT));
+	GLCall(m_BlendWasEnabled = glIsEnabled(GL_BLEND));
+	GLCall(glDisable(GL_BLEND));
+
+	feedbackShader.Bind();
+	feedbackShader.SetUniform2f("u_VirtualSize", (float)m_Pyramid.GetWidth(), (float)m_Pyramid.GetHeight());
+	feedbackShader.SetUniform1f("u_PageSize", (float)m_TileSize);
+	feedbackShader.SetUniform1i("u_MaxLevel", m_Pyramid.GetLevelCount() - 1);
+	feedbackShader.SetUniform1f("u_LevelBias", -std::log2((float)m_FeedbackScale));
+}
+
+void VirtualTexture::EndFeedback()
+{
+	if (!IsOpen())
+		return;
+
+	//Read into a pixel buffer and only look at it next frame, so the GPU never has to be waited on
+	const int width = m_Feedback->GetWidth(), height = m_Feedback->GetHeight();
+	GLCall(glBindBuffer(GL_PIXEL_PACK_BUFFER, m_FeedbackBuffers[m_FeedbackIndex]));
+	GLCall(glBufferData(GL_PIXEL_PACK_BUFFER, (size_t)width * height * 4, nullptr, GL_STREAM_READ));
+	GLCall(glReadPixels(0, 0, width, height, GL_RGBA, GL_UNSIGNED_BYTE, nullptr));
+	GLCall(glBindBuffer(GL_PIXEL_PACK_BUFFER, 0));
+	m_FeedbackSize[m_FeedbackIndex][0] = width;
+	m_FeedbackSize[m_FeedbackIndex][1] = height;
+
+	m_Feedback->UnBind();
+	GLCall(glClearColor(m_ClearColour[0], m_ClearColour[1], m_ClearColour[2], m_ClearColour[3]));
+	if (m_BlendWasEnabled)
+	{
+		GLCall(glEnable(GL_BLEND));
+	}
+
+	m_FeedbackIndex = (m_FeedbackIndex + 1) % FeedbackBufferCount;
+	if (m_FeedbackSize[m_FeedbackIndex][0] != 0)
+		ReadFeedback(m_FeedbackIndex);
+}
+
+void VirtualTexture::ReadFeedback(int buffer)
+{
+	const int width = m_FeedbackSize[buffer][0], height = m_FeedbackSize[buffer][1];
+	m_FeedbackSize[buffer][0] = m_FeedbackSize[buffer][1] = 0;
+
+	std::unordered_set<uint64_t> wanted;
+	const int topLevel = m_Pyramid.GetLevelCount() - 1;
+
+	GLCall(glBindBuffer(GL_PIXEL_PACK_BUFFER, m_FeedbackBuffers[buffer]));
+	GLCall(const unsigned char* pixels = (const unsigned char*)glMapBufferRange(GL_PIXEL_PACK_BUFFER, 0, (size_t)width * height * 4, GL_MAP_READ_BIT));
+	if (pixels)
+	{
+		for (int i = 0; i < width * height; i++)
+		{
+			const unsigned char* pixel = pixels + i * 4;
+			if (pixel[3] == 0)
+				continue;
+
+			const int level = std::min((int)pixel[3] - 1, topLevel);
+			const TilePyramid::Level& info = m_Pyramid.GetLevel(level);
+			const int x = std::min(pixel[0] | ((pixel[2] & 15) << 8), info.TilesX - 1);
+			const int y = std::min(pixel[1] | ((pixel[2] >> 4) << 8), info.TilesY - 1);
+			wanted.insert(MakeKey(level, x, y));
+		}
+		GLCall(glUnmapBuffer(GL_PIXEL_PACK_BUFFER));
+	}
+	GLCall(glBindBuffer(GL_PIXEL_PACK_BUFFER, 0));
+
+	//Every missing page between a wanted one and its closest resident ancestor is requested, so detail
+	//sharpens a level at a time instead of waiting for the finest page
+	std::unordered_set<uint64_t> neededSet;
+	for (uint64_t key : wanted)
+	{
+		const int level = GetKeyLevel(key), x = GetKeyX(key), y = GetKeyY(key);
+		for (int parent = level; parent <= topLevel; parent++)
+		{
+			const uint64_t parentKey = MakeKey(parent, x >> (parent - level), y >> (parent - level));
+			auto it = m_Resident.find(parentKey);
+			if (it != m_Resident.end())
+			{
+				if (m_Slots[it->second].LastUsedFrame != UINT_MAX)
+					m_Slots[it->second].LastUsedFrame = m_Frame;
+				break;
+			}
+			neededSet.insert(parentKey);
+		}
+	}
+
+	//Coarse pages first, they cover the most screen
+	std::vector<uint64_t> needed(neededSet.begin(), neededSet.end());
+	std::sort(needed.begin(), needed.end(), [](uint64_t a, uint64_t b) { return a > b; });
+
+	{
+		std::lock_guard<std::mutex> lock(m_Mutex);
+		//Requests from older frames that haven't been started are dropped, the view has moved on
+		for (uint64_t key : m_Requests)
+			m_InFlight.erase(key);
+		m_Requests.clear();
+
+		for (uint64_t key : needed)
+		{
+			if (m_InFlight.insert(key).second)
+				m_Requests.push_back(key);
+		}
+	}
+	m_Condition.notify_one();
+}
+
+void VirtualTexture::WorkerLoop()
+{
+	CpuProfiler::SetThreadName("Virtual texture pages");
+	const size_t pageSize = (size_t)m_Pyramid.GetPaddedSize() * m_Pyramid.GetPaddedSize() * 4;
+	while (true)
+	{
+		uint64_t key;
+		{
+			std::unique_lock<std::mutex> lock(m_Mutex);
+			m_Condition.wait(lock, [this] { return !m_Running || !m_Requests.empty(); });
+			if (!m_Running)
+				return;
+
+			key = m_Requests.front();
+			m_Requests.pop_front();
+		}
+
+		PROFILE_SCOPE("Read page");
+
+		//Copying out of the mapped file is what pulls the page in from disk, so it happens here rather than on the GL thread
+		const unsigned char* tile = m_Pyramid.GetTile(GetKeyLevel(key), GetKeyX(key), GetKeyY(key));
+		LoadedPage page = { key, std::vector<unsigned char>(tile, tile + pageSize) };
+
+		std::lock_guard<std::mutex> lock(m_Mutex);
+		m_Loaded.push_back(std::move(page));
+	}
+}
+
+void VirtualTexture::Update(unsigned int uploadBudget)
+{
+	if (!IsOpen())
+		return;
+
+	for (unsigned int i = 0; i < uploadBudget; i++)
+	{
+		LoadedPage page;
+		{
+			std::lock_guard<std::mutex> lock(m_Mutex);
+			if (m_Loaded.empty())
+				break;
+
+			page = std::move(m_Loaded.front());
+			m_Loaded.pop_front();
+			m_InFlight.erase(page.Key);
+		}
+		UploadPage(page.Key, page.Pixels.data(), false);
+	}
+
+	if (!m_ChangedPages.empty())
+		UpdateIndirection();
+}
+
+void VirtualTexture::UploadPage(uint64_t key, const unsigned char* pixels, bool pinned)
+{
+	if (m_Resident.count(key))
+		return;
+
+	//An empty slot, otherwise the one used longest ago that wasn't asked for this frame
+	int slot = -1;
+	for (int i = 0; i < (int)m_Slots.size(); i++)
+	{
+		if (m_Slots[i].Key == InvalidKey)
+		{
+			slot = i;
+			break;
+		}
+		if (m_Slots[i].LastUsedFrame < m_Frame && (slot < 0 || m_Slots[i].LastUsedFrame < m_Slots[slot].LastUsedFrame))
+			slot = i;
+	}
+	if (slot < 0)
+		return;
+
+	if (m_Slots[slot].Key != InvalidKey)
+	{
+		m_Resident.erase(m_Slots[slot].Key);
+		m_ChangedPages.push_back(m_Slots[slot].Key);
+	}
+	m_Slots[slot] = { key, pinned ? UINT_MAX : m_Frame };
+	m_Resident[key] = slot;
+	m_ChangedPages.push_back(key);
+
+	const int paddedSize = m_Pyramid.GetPaddedSize();
+	GLCall(glBindTexture(GL_TEXTURE_2D, m_PageCache->GetRendererID()));
+	GLCall(glTexSubImage2D(GL_TEXTURE_2D, 0, (slot % m_SlotsPerRow) * paddedSize, (slot / m_SlotsPerRow) * paddedSize,
+		paddedSize, paddedSize, GL_RGBA, GL_UNSIGNED_BYTE, pixels));
+	RenderStats::Current().TextureBytesUploaded += (size_t)paddedSize * paddedSize * 4;
+	GLCall(glBindTexture(GL_TEXTURE_2D, 0));
+}
+
+void VirtualTexture::UpdateIndirection()
+{
+	//Layer n maps every level 0 page to the finest resident page at level n or above that covers it. A page
+	//coming or going only changes the entries under it, in its own level's layer and the finer ones, so only
+	//those rectangles are rebuilt and uploaded
+	const TilePyramid::Level& base = m_Pyramid.GetLevel(0);
+	const size_t layerSize = (size_t)base.TilesX * base.TilesY * 4;
+	const int topLevel = m_Pyramid.GetLevelCount() - 1;
+
+	std::unordered_set<uint64_t> changed(m_ChangedPages.begin(), m_ChangedPages.end());
+	m_ChangedPages.clear();
+	for (uint64_t key : changed)
+	{
+		const int pageLevel = GetKeyLevel(key), pageX = GetKeyX(key), pageY = GetKeyY(key);
+
+		//A changed page above this one already rebuilds everything under it
+		bool covered = false;
+		for (int parent = pageLevel + 1; parent <= topLevel && !covered; parent++)
+		{
+			const TilePyramid::Level& info = m_Pyramid.GetLevel(parent);
+			const int shift = parent - pageLevel;
+			covered = changed.count(MakeKey(parent, std::min(pageX >> shift, info.TilesX - 1), std::min(pageY >> shift, info.TilesY - 1))) != 0;
+		}
+		if (covered)
+			continue;
+
+		//The last page of a row or column also covers the level 0 pages past its edge, see the clamp below
+		const TilePyramid::Level& page = m_Pyramid.GetLevel(pageLevel);
+		const int left = std::min(pageX << pageLevel, base.TilesX), bottom = std::min(pageY << pageLevel, base.TilesY);
+		const int right = pageX == page.TilesX - 1 ? base.TilesX : std::min((pageX + 1) << pageLevel, base.TilesX);
+		const int top = pageY == page.TilesY - 1 ? base.TilesY : std::min((pageY + 1) << pageLevel, base.TilesY);
+
+		for (int level = pageLevel; level >= 0; level--)
+		{
+			const TilePyramid::Level& info = m_Pyramid.GetLevel(level);
+			unsigned char* layer = m_IndirectionData.data() + layerSize * level;
+			for (int y = bottom; y < top; y++)
+			{
+				for (int x = left; x < right; x++)
+				{
+					unsigned char* entry = layer + ((size_t)y * base.TilesX + x) * 4;
+					auto it = m_Resident.find(MakeKey(level, std::min(x >> level, info.TilesX - 1), std::min(y >> level, info.TilesY - 1)));
+					if (it != m_Resident.end())
+					{
+						entry[0] = (unsigned char)(it->second % m_SlotsPerRow);
+						entry[1] = (unsigned char)(it->second / m_SlotsPerRow);
+						entry[2] = (unsigned char)level;
+						entry[3] = 255;
+					}
+					else if (level < topLevel)
+						memcpy(entry, entry + layerSize, 4);
+					else
+						memset(entry, 0, 4);
+				}
+			}
+			m_Indirection->SetRegion(level, left, bottom, right - left, top - bottom, layer + ((size_t)bottom * base.TilesX + left) * 4, base.TilesX);
+		}
+	}
+}
+
+void VirtualTexture::Bind(Shader& shader, unsigned int cacheSlot, unsigned int indirectionSlot) const
+{
+	if (!IsOpen())
+		return;
+
+	m_PageCache->Bind(cacheSlot);
+	m_Indirection->Bind(indirectionSlot);
+
+	shader.Bind();
+	shader.SetUniform1i("u_PageCache", cacheSlot);
+	shader.SetUniform1i("u_Indirection", indirectionSlot);
+	shader.SetUniform2f("u_VirtualSize", (float)m_Pyramid.GetWidth(), (float)m_Pyramid.GetHeight());
+	shader.SetUniform1f("u_PageSize", (float)m_TileSize);
+	shader.SetUniform1f("u_CacheSize", (float)m_CacheSize);
+	shader.SetUniform1i("u_MaxLevel", m_Pyramid.GetLevelCount() - 1);
+}
@@ -0,0 +1,107 @@
+#pragma once
+
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+#include "Framebuffer.h"
+#include "Texture.h"
+#include "Texture2DArray.h"
+#include "TilePyramid.h"
+#include "shader.h"
+
+//Sparse virtual texturing over a TilePyramid. Only the pages the scene actually samples are kept in a fixed
+//size physical page cache, so texture memory stays the same however much unique content the pyramid holds.
+//Each frame the scene is drawn once more at low resolution with the VirtualTextureFeedback shader between
+//BeginFeedback and EndFeedback, which records the page and level every pixel wants. The feedback is read back
+//a frame later, missing pages are read from disk on a worker thread and Update copies them into the cache
+//and rewrites the indirection texture the VirtualTexture shader uses to find them.
+class VirtualTexture
+{
+private:
+	struct Slot
+	{
+		uint64_t Key; //Level, page x and page y packed together, InvalidKey when empty
+		unsigned int LastUsedFrame;
+	};
+
+	struct LoadedPage
+	{
+		uint64_t Key;
+		std::vector<unsigned char> Pixels;
+	};
+
+	static const uint64_t InvalidKey = ~0ull;
+	static const int FeedbackBufferCount = 2;
+
+	TilePyramid m_Pyramid;
+	int m_TileSize;
+
+	//Only touched by the GL thread
+	std::unique_ptr<Texture> m_PageCache;
+	int m_CacheSize, m_SlotsPerRow;
+	std::vector<Slot> m_Slots;
+	std::unordered_map<uint64_t, int> m_Resident;
+	std::unique_ptr<Texture2DArray> m_Indirection;
+	std::vector<unsigned char> m_IndirectionData;
+	std::vector<uint64_t> m_ChangedPages; //Added or evicted since the indirection was last updated
+	unsigned int m_Frame;
+
+	std::unique_ptr<Framebuffer> m_Feedback;
+	int m_FeedbackScale;
+	unsigned int m_FeedbackBuffers[FeedbackBufferCount];
+	int m_FeedbackSize[FeedbackBufferCount][2]; //Of the read waiting in each buffer, 0 when it is free
+	int m_FeedbackIndex;
+	bool m_BlendWasEnabled;
+	float m_ClearColour[4];
+
+	//Shared with the worker
+	std::thread m_Worker;
+	std::mutex m_Mutex;
+	std::condition_variable m_Condition;
+	std::deque<uint64_t> m_Requests;
+	std::unordered_set<uint64_t> m_InFlight; //Requested, being read or waiting to be uploaded
+	std::deque<LoadedPage> m_Loaded;
+	bool m_Running;
+
+public:
+	//cacheSize is the width and height of the physical page cache, feedbackScale how much smaller than the
+	//screen the feedback pass is drawn
+	VirtualTexture(const std::string& pyramidPath, int cacheSize = 4096, int feedbackScale = 8);
+	~VirtualTexture();
+
+	//Redirects drawing into the feedback framebuffer and sets the feedback shader's uniforms, the scene is drawn
+	//with that shader before calling EndFeedback
+	void BeginFeedback(Shader& feedbackShader, int viewWidth, int viewHeight);
+	void EndFeedback();
+
+	//Uploads at most uploadBudget pages that have been read since the last call
+	void Update(unsigned int uploadBudget = 8);
+
+	//Binds the page cache and indirection texture and sets the VirtualTexture shader's uniforms
+	void Bind(Shader& shader, unsigned int cacheSlot = 0, unsigned int indirectionSlot = 1) const;
+
+	inline bool IsOpen() const { return m_Pyramid.IsOpen(); }
+	inline int GetWidth() const { return m_Pyramid.GetWidth(); }
+	inline int GetHeight() const { return m_Pyramid.GetHeight(); }
+	inline unsigned int GetResidentPageCount() const { return (unsigned int)m_Resident.size(); }
+	inline unsigned int GetPageCapacity() const { return (unsigned int)m_Slots.size(); }
+
+private:
+	void WorkerLoop();
+	void ReadFeedback(int buffer);
+	void UploadPage(uint64_t key, const unsigned char* pixels, bool pinned);
+	void UpdateIndirection();
+
+	static inline uint64_t MakeKey(int level, int x, int y) { return ((uint64_t)level << 48) | ((uint64_t)y << 24) | (uint64_t)x; }
+	static inline int GetKeyLevel(uint64_t key) { return (int)(key >> 48); }
+	static inline int GetKeyY(uint64_t key) { return (int)((key >> 24) & 0xFFFFFF); }
+	static inline int GetKeyX(uint64_t key) { return (int)(key & 0xFFFFFF); }
+};
@@ -1,17 +1,54 @@
 #include "shader.h"
 #include "Renderer.h"
+#include "CpuProfiler.h"
+#include "GLDebugOutput.h"
+#include "Log.h"
+#include "RenderStats.h"
 
-#include <iostream>
+#include <cstring>
 #include <fstream>
 #include <string>
 #include <sstream>
+#include <algorithm>
 
+namespace
+{
+	//A line at a time so a long log isn't cut short to fit one message
+	void LogInfoLog(const char* log)
+	{
+		while (*log)
+		{
+			const char* end = strchr(log, '\n');
+			const size_t length = end ? end - log : strlen(log);
+			Log::Error("{}", std::string_view(log, length));
+			log += end ? length + 1 : length;
+		}
+	}
+}
+
+//Loads and parses the file at runtime, mostly useful for shaders that aren't embedded yet
 Shader::Shader(const std::string& filepath)
 	:m_FilePath(filepath), m_RendererID(0)
 {
-	ShaderProgramSource source = ParseShader(filepath);
-	m_RendererID = CreateShader(source.VertexSource, source.FragmentSource);
-	
+	Create(ParseShader(filepath));
+}
+
+//Uses the pre split sources compiled into the binary so there's no file I/O or parsing,
+//the file path is still kept so the ShaderWatcher can reload it from disk during development
+Shader::Shader(EmbeddedShaderID id)
+	:m_FilePath(GetEmbeddedShader(id).FilePath), m_RendererID(0)
+{
+	const EmbeddedShader& embedded = GetEmbeddedShader(id);
+	Create({ std::string(embedded.VertexSource), std::string(embedded.FragmentSource), std::string(embedded.ComputeSource) });
+}
+
+void Shader::Create(const ShaderProgramSource& source)
+{
+	m_RendererID = CreateShader(source);
+	CheckProgram(m_RendererID);
+	GLDebugOutput::SetLabel(GL_PROGRAM, m_RendererID, m_FilePath);
+	GLCall(glValidateProgram(m_RendererID));
+	ReflectAttributes();
 }
 Shader::~Shader()
 {
@@ -24,11 +61,11 @@ ShaderProgramSource Shader::ParseShader(const std::string& filepath)
 
 	enum class ShaderType
 	{
-		NONE = -1, VERTEX = 0, FRAGMENT = 1
+		NONE = -1, VERTEX = 0, FRAGMENT = 1, COMPUTE = 2
 	};
 	
 	std::string line;
-	std::stringstream ss[2];
+	std::stringstream ss[3];
 	ShaderType type = ShaderType::NONE;
 	
 	while (getline(stream, line))
@@ -39,16 +76,19 @@ ShaderProgramSource Shader::ParseShader(const std::string& filepath)
 				type = ShaderType::VERTEX;			
 			else if (line.find("fragment") != std::string::npos)
 				type = ShaderType::FRAGMENT;
+			else if (line.find("compute") != std::string::npos)
+				type = ShaderType::COMPUTE;
 			
 		}
-		else
+		else if (type != ShaderType::NONE) //Anything before the first #shader line doesn't belong to a stage
 		{
 			ss[(int)type] << line << "\n";	
 		}
 	}
 
-	return {ss[0].str(), ss[1].str()};
+	return {ss[0].str(), ss[1].str(), ss[2].str()};
 }
+//This only issues the compile, the status is checked by CheckProgram so that drivers with parallel compile don't block here
 unsigned int Shader::CompileShader(unsigned int type, const std::string& source)
 {
 	GLCall(unsigned int id = glCreateShader(type));
@@ -56,44 +96,201 @@ unsigned int Shader::CompileShader(unsigned int type, const std::string& source)
 	GLCall(glShaderSource(id, 1, &src, nullptr));
 	GLCall(glCompileShader(id));
 	
-	int result;
-	GLCall(glGetShaderiv(id, GL_COMPILE_STATUS, &result));
+	return id;
+}
+unsigned int Shader::CreateShader(const ShaderProgramSource& source)
+{
+	unsigned int program = CompileProgram(source);
+	LinkProgram(program);
+	return program;
+}
+
+//A file with a compute stage is linked on its own, otherwise the vertex and fragment stages are linked together
+unsigned int Shader::CompileProgram(const ShaderProgramSource& source)
+{
+	PROFILE_SCOPE("Compile shader");
+	GLCall(unsigned int program = glCreateProgram());
+
+	unsigned int stages[2];
+	int count = 0;
+	if (!source.ComputeSource.empty())
+	{
+		stages[count++] = CompileShader(GL_COMPUTE_SHADER, source.ComputeSource);
+	}
+	else
+	{
+		stages[count++] = CompileShader(GL_VERTEX_SHADER, source.VertexSource);
+		stages[count++] = CompileShader(GL_FRAGMENT_SHADER, source.FragmentSource);
+	}
+
+	//Deleting only flags the shaders, they stay alive while attached so they can be linked later and
+	//CheckProgram can still read their logs
+	for (int i = 0; i < count; i++)
+	{
+		GLCall(glAttachShader(program, stages[i]));
+		GLCall(glDeleteShader(stages[i]));
+	}
+
+	return program;
+}
+
+void Shader::LinkProgram(unsigned int program)
+{
+	GLCall(glLinkProgram(program));
+}
+
+//Returns false and prints the logs if any attached shader failed to compile or the program failed to link
+bool Shader::CheckProgram(unsigned int program)
+{
+	PROFILE_SCOPE("Link shader"); //Where the compile actually waits
+	unsigned int shaders[2];
+	int count = 0;
+	GLCall(glGetAttachedShaders(program, 2, &count, shaders));
+	
+	for (int i = 0; i < count; i++)
+	{
+		int result;
+		GLCall(glGetShaderiv(shaders[i], GL_COMPILE_STATUS, &result));
 
-	//If the result comes back false then an error will be thrown
+		//If the result comes back false then an error will be thrown
+		if (result == GL_FALSE)
+		{
+			int type, length;
+			glGetShaderiv(shaders[i], GL_SHADER_TYPE, &type);
+			glGetShaderiv(shaders[i], GL_INFO_LOG_LENGTH, &length);
+			char* message = (char*)alloca(sizeof(char) * length);
+			glGetShaderInfoLog(shaders[i], length, &length, message);
+			Log::Error("Failed to compile {}shader!", (type == GL_VERTEX_SHADER ? "vertex" : type == GL_COMPUTE_SHADER ? "compute" : "Fragment"));
+			LogInfoLog(message);
+			return false;
+		}
+	}
+
+	int result;
+	GLCall(glGetProgramiv(program, GL_LINK_STATUS, &result));
 	if (result == GL_FALSE)
 	{
 		int length;
-		glGetShaderiv(id, GL_INFO_LOG_LENGTH, &length);
+		glGetProgramiv(program, GL_INFO_LOG_LENGTH, &length);
 		char* message = (char*)alloca(sizeof(char) * length);
-		glGetShaderInfoLog(id, length, &length, message);
-		std::cout << "Failed to compile " << (type == GL_VERTEX_SHADER ? "vertex" : "Fragment") <<"shader!" << std::endl;
-		std::cout << message << std::endl;
-
-		glDeleteShader(id);
-		return 0;
+		glGetProgramInfoLog(program, length, &length, message);
+		Log::Error("Failed to link shader program!");
+		LogInfoLog(message);
+		return false;
 	}
 	
-	return id;
+	return true;
 }
-unsigned int Shader::CreateShader(const std::string& vertexShader, const std::string& fragmentShader)
+
+//Replaces the program with a freshly linked one, looks the cached uniform names up again and sets them to the
+//values they had, as a new program starts with every uniform at zero
+void Shader::SwapProgram(unsigned int program)
 {
-	GLCall(unsigned int program = glCreateProgram());
-	unsigned int vs = CompileShader(GL_VERTEX_SHADER, vertexShader);
-	unsigned int fs = CompileShader(GL_FRAGMENT_SHADER, fragmentShader);
+	int previous;
+	GLCall(glGetIntegerv(GL_CURRENT_PROGRAM, &previous));
+	const unsigned int oldProgram = m_RendererID;
+	m_RendererID = program;
+	GLDebugOutput::SetLabel(GL_PROGRAM, m_RendererID, m_FilePath);
 
-	GLCall(glAttachShader(program, vs));
-	GLCall(glAttachShader(program, fs));
-	GLCall(glLinkProgram(program));
-	GLCall(glValidateProgram(program));
+	GLCall(glUseProgram(m_RendererID));
+	for (auto& entry : m_Uniforms)
+	{
+		GLCall(entry.second.Location = glGetUniformLocation(m_RendererID, entry.first.c_str()));
+		UploadUniform(entry.second);
+	}
+	GLCall(glUseProgram((unsigned int)previous == oldProgram ? m_RendererID : previous));
+	GLCall(glDeleteProgram(oldProgram));
+	ReflectAttributes();
+}
+
+//Reads back which vertex inputs survived linking so layouts can be checked against them
+void Shader::ReflectAttributes()
+{
+	m_Attributes.clear();
 
-	GLCall(glDeleteShader(vs));
-	GLCall(glDeleteShader(fs));
+	int count = 0, maxLength = 0;
+	GLCall(glGetProgramiv(m_RendererID, GL_ACTIVE_ATTRIBUTES, &count));
+	GLCall(glGetProgramiv(m_RendererID, GL_ACTIVE_ATTRIBUTE_MAX_LENGTH, &maxLength));
 
-	return program;
+	std::vector<char> name(maxLength + 1);
+	for (int i = 0; i < count; i++)
+	{
+		int length, size;
+		unsigned int type;
+		GLCall(glGetActiveAttrib(m_RendererID, i, maxLength + 1, &length, &size, &type, name.data()));
+		GLCall(int location = glGetAttribLocation(m_RendererID, name.data()));
+
+		//Built in inputs like gl_VertexID don't have a location and aren't fed by a buffer
+		if (location == -1)
+			continue;
+
+		m_Attributes.push_back({ std::string(name.data(), length), location, type, size });
+	}
+
+	std::sort(m_Attributes.begin(), m_Attributes.end(), [](const ShaderAttribute& a, const ShaderAttribute& b)
+	{
+		return a.Location < b.Location;
+	});
+}
+
+bool Shader::IsAttributeActive(unsigned int location) const
+{
+	for (const auto& attribute : m_Attributes)
+	{
+		if ((int)location >= attribute.Location && location < attribute.Location + attribute.GetLocationCount())
+			return true;
+	}
+	return false;
+}
+
+unsigned int ShaderAttribute::GetComponentType() const
+{
+	switch (Type)
+	{
+		case GL_INT: case GL_INT_VEC2: case GL_INT_VEC3: case GL_INT_VEC4:
+			return GL_INT;
+		case GL_UNSIGNED_INT: case GL_UNSIGNED_INT_VEC2: case GL_UNSIGNED_INT_VEC3: case GL_UNSIGNED_INT_VEC4:
+			return GL_UNSIGNED_INT;
+		case GL_DOUBLE: case GL_DOUBLE_VEC2: case GL_DOUBLE_VEC3: case GL_DOUBLE_VEC4:
+			return GL_DOUBLE;
+	}
+	return GL_FLOAT;
+}
+
+unsigned int ShaderAttribute::GetComponentCount() const
+{
+	switch (Type)
+	{
+		case GL_FLOAT: case GL_INT: case GL_UNSIGNED_INT: case GL_DOUBLE:
+			return 1;
+		case GL_FLOAT_VEC2: case GL_INT_VEC2: case GL_UNSIGNED_INT_VEC2: case GL_DOUBLE_VEC2:
+		case GL_FLOAT_MAT2: case GL_FLOAT_MAT3x2: case GL_FLOAT_MAT4x2:
+			return 2;
+		case GL_FLOAT_VEC3: case GL_INT_VEC3: case GL_UNSIGNED_INT_VEC3: case GL_DOUBLE_VEC3:
+		case GL_FLOAT_MAT3: case GL_FLOAT_MAT2x3: case GL_FLOAT_MAT4x3:
+			return 3;
+	}
+	return 4;
+}
+
+unsigned int ShaderAttribute::GetLocationCount() const
+{
+	unsigned int columns = 1;
+	switch (Type)
+	{
+		case GL_FLOAT_MAT2: case GL_FLOAT_MAT2x3: case GL_FLOAT_MAT2x4:
+			columns = 2; break;
+		case GL_FLOAT_MAT3: case GL_FLOAT_MAT3x2: case GL_FLOAT_MAT3x4:
+			columns = 3; break;
+		case GL_FLOAT_MAT4: case GL_FLOAT_MAT4x2: case GL_FLOAT_MAT4x3:
+			columns = 4; break;
+	}
+	return columns * Size;
 }
 
 void Shader::Bind() const
 {
+	RenderStats::Current().ProgramBinds++;
 	GLCall(glUseProgram(m_RendererID));
 }
 void Shader::UnBind() const
@@ -103,33 +300,80 @@ void Shader::UnBind() const
 
 void Shader::SetUniform4f(const std::string& name, float v0, float v1, float v2, float v3)
 {
-
-	GLCall(glUniform4f(GetUniformLocation(name), v0,v1,v2,v3));
-	
+	Uniform& uniform = GetUniform(name);
+	uniform.Type = GL_FLOAT_VEC4;
+	uniform.Floats[0] = v0;
+	uniform.Floats[1] = v1;
+	uniform.Floats[2] = v2;
+	uniform.Floats[3] = v3;
+	UploadUniform(uniform);
+}
+void Shader::SetUniform2f(const std::string& name, float v0, float v1)
+{
+	Uniform& uniform = GetUniform(name);
+	uniform.Type = GL_FLOAT_VEC2;
+	uniform.Floats[0] = v0;
+	uniform.Floats[1] = v1;
+	UploadUniform(uniform);
 }
 void Shader::SetUniform1f(const std::string& name, float value)
 {
-	GLCall(glUniform1f(GetUniformLocation(name), value));
+	Uniform& uniform = GetUniform(name);
+	uniform.Type = GL_FLOAT;
+	uniform.Floats[0] = value;
+	UploadUniform(uniform);
 }
 void Shader::SetUniform1i(const std::string& name, int value)
 {
-	GLCall(glUniform1i(GetUniformLocation(name), value));
-
+	Uniform& uniform = GetUniform(name);
+	uniform.Type = GL_INT;
+	uniform.Int = value;
+	UploadUniform(uniform);
 }
 void Shader::SetUniformMat4f(const std::string& name, const glm::mat4& matrix)
 {
-	GLCall(glUniformMatrix4fv(GetUniformLocation(name), 1, GL_FALSE, &matrix[0][0]));
+	Uniform& uniform = GetUniform(name);
+	uniform.Type = GL_FLOAT_MAT4;
+	memcpy(uniform.Floats, &matrix[0][0], sizeof(uniform.Floats));
+	UploadUniform(uniform);
+}
+
+//Sends the stored value to the bound program, which has to be this one
+void Shader::UploadUniform(const Uniform& uniform)
+{
+	RenderStats::Current().UniformUploads++;
+	switch (uniform.Type)
+	{
+		case GL_FLOAT_VEC4:
+			GLCall(glUniform4f(uniform.Location, uniform.Floats[0], uniform.Floats[1], uniform.Floats[2], uniform.Floats[3]));
+			break;
+		case GL_FLOAT_VEC2:
+			GLCall(glUniform2f(uniform.Location, uniform.Floats[0], uniform.Floats[1]));
+			break;
+		case GL_FLOAT:
+			GLCall(glUniform1f(uniform.Location, uniform.Floats[0]));
+			break;
+		case GL_INT:
+			GLCall(glUniform1i(uniform.Location, uniform.Int));
+			break;
+		case GL_FLOAT_MAT4:
+			GLCall(glUniformMatrix4fv(uniform.Location, 1, GL_FALSE, uniform.Floats));
+			break;
+	}
 }
 
-int Shader::GetUniformLocation(const std::string& name)
+Shader::Uniform& Shader::GetUniform(const std::string& name)
 {
-	if (m_UniformLocationCache.find(name) != m_UniformLocationCache.end())
-		return m_UniformLocationCache[name];
+	auto it = m_Uniforms.find(name);
+	if (it != m_Uniforms.end())
+		return it->second;
 	
 	GLCall(int location = glGetUniformLocation(m_RendererID, name.c_str()));
 	if (location == -1)
-		std::cout << "Warning: Uniform " << name << " doesn't exist!" << std::endl;
+		Log::Warning("Warning: Uniform {} doesn't exist!", name);
 	
-	m_UniformLocationCache[name] = location;
-	return location;
+	Uniform& uniform = m_Uniforms[name];
+	uniform.Location = location;
+	uniform.Type = 0;
+	return uniform;
 }
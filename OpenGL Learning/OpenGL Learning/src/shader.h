@@ -2,24 +2,55 @@
 
 #include <string>
 #include <unordered_map>
+#include <vector>
 
 #include "glm/glm.hpp"
+#include "EmbeddedShaders.h"
 
 struct ShaderProgramSource
 {
 	std::string VertexSource;
 	std::string FragmentSource;
+	std::string ComputeSource;
+};
+
+//An input the linked program actually reads, as reported by glGetActiveAttrib
+struct ShaderAttribute
+{
+	std::string Name;
+	int Location;
+	unsigned int Type; //GL_FLOAT_VEC2, GL_FLOAT_MAT4 etc.
+	int Size; //Array length, 1 if it isn't an array
+
+	//What a single location of this input is made of, e.g. GL_FLOAT and 4 for each column of a mat4
+	unsigned int GetComponentType() const;
+	unsigned int GetComponentCount() const;
+	unsigned int GetLocationCount() const;
 };
 
 class Shader
 {
 private:
+	//A cached location and the last value set there
+	struct Uniform
+	{
+		int Location;
+		unsigned int Type; //GL_FLOAT_VEC4, GL_FLOAT_VEC2, GL_FLOAT, GL_INT or GL_FLOAT_MAT4, 0 until a value is set
+		union
+		{
+			float Floats[16];
+			int Int;
+		};
+	};
+
 	std::string m_FilePath;
 	unsigned int m_RendererID;
-	std::unordered_map<std::string, int> m_UniformLocationCache;
-	
+	std::unordered_map<std::string, Uniform> m_Uniforms;
+	std::vector<ShaderAttribute> m_Attributes;
+
 public:
 	Shader(const std::string& filepath);
+	Shader(EmbeddedShaderID id);
 	~Shader();
 
 	void Bind() const;
@@ -27,13 +58,30 @@ public:
 
 	//Set uniforms
 	void SetUniform4f(const std::string& name, float v0, float v1, float v2, float v3);
+	void SetUniform2f(const std::string& name, float v0, float v1);
 	void SetUniform1f(const std::string& name, float value);
 	void SetUniform1i(const std::string& name, int value);
 	void SetUniformMat4f(const std::string& name, const glm::mat4& matrix);
 
+	inline const std::string& GetFilePath() const { return m_FilePath; }
+	inline unsigned int GetRendererID() const { return m_RendererID; }
+
+	//Active vertex inputs sorted by location
+	inline const std::vector<ShaderAttribute>& GetAttributes() const { return m_Attributes; }
+	bool IsAttributeActive(unsigned int location) const;
+
 private:
-	unsigned int CreateShader(const std::string& vertexShader, const std::string& fragmentShader);
-	unsigned int CompileShader(unsigned int type, const std::string& source);
-	ShaderProgramSource ParseShader(const std::string& filepath);
-	int GetUniformLocation(const std::string& name);
-};
\ No newline at end of file
+	friend class ShaderWatcher;
+
+	void Create(const ShaderProgramSource& source);
+	static unsigned int CreateShader(const ShaderProgramSource& source);
+	static unsigned int CompileProgram(const ShaderProgramSource& source);
+	static void LinkProgram(unsigned int program);
+	static unsigned int CompileShader(unsigned int type, const std::string& source);
+	static ShaderProgramSource ParseShader(const std::string& filepath);
+	static bool CheckProgram(unsigned int program);
+	void SwapProgram(unsigned int program);
+	void ReflectAttributes();
+	Uniform& GetUniform(const std::string& name);
+	void UploadUniform(const Uniform& uniform);
+};
@@ -0,0 +1,106 @@
+#!/usr/bin/env python3
+# Generates src/EmbeddedShaders.h from every .shader file in res/shaders.
+# Each file is split into its stages the same way Shader::ParseShader does it, so the
+# application can build a Shader from an EmbeddedShaderID without touching the disk.
+#
+# Usage: EmbedShaders.py <shader directory> <output header>
+
+import os
+import re
+import sys
+
+STAGES = ("vertex", "fragment", "compute")
+DELIMITER = "SHADER"
+# MSVC limits a single string literal to ~16KB so long sources are split into adjacent literals
+CHUNK_SIZE = 8000
+
+
+def split_stages(path):
+    sources = {stage: "" for stage in STAGES}
+    current = None
+    with open(path, "r", encoding="utf-8") as f:
+        for line in f.read().splitlines():
+            if "#shader" in line:
+                current = next((stage for stage in STAGES if stage in line), current)
+            elif current is not None:
+                sources[current] += line + "\n"
+    return sources
+
+
+def literal(source):
+    if ")" + DELIMITER + '"' in source:
+        raise ValueError("shader source contains the raw string delimiter")
+    if not source:
+        return '""'
+    chunks = [source[i:i + CHUNK_SIZE] for i in range(0, len(source), CHUNK_SIZE)]
+    return " ".join('R"{0}({1}){0}"'.format(DELIMITER, chunk) for chunk in chunks)
+
+
+def identifier(name):
+    name = re.sub(r"\W", "_", name)
+    return "_" + name if name[0].isdigit() else name
+
+
+def main():
+    if len(sys.argv) != 3:
+        print("usage: EmbedShaders.py <shader directory> <output header>")
+        return 1
+
+    directory, output = sys.argv[1], sys.argv[2]
+    files = sorted(f for f in os.listdir(directory) if f.endswith(".shader"))
+
+    lines = [
+        "//Generated by tools/EmbedShaders.py from res/shaders, don't edit this file by hand",
+        "#pragma once",
+        "",
+        "#include <string_view>",
+        "",
+        "enum class EmbeddedShaderID",
+        "{",
+    ]
+    lines += ["\t{},".format(identifier(os.path.splitext(f)[0])) for f in files]
+    lines += [
+        "\tCount",
+        "};",
+        "",
+        "struct EmbeddedShader",
+        "{",
+        "\tstd::string_view FilePath; //Where the source lives on disk, used to hot reload it during development",
+        "\tstd::string_view VertexSource;",
+        "\tstd::string_view FragmentSource;",
+        "\tstd::string_view ComputeSource;",
+        "};",
+        "",
+        "inline constexpr EmbeddedShader s_EmbeddedShaders[] =",
+        "{",
+    ]
+    for f in files:
+        sources = split_stages(os.path.join(directory, f))
+        lines.append("\t{")
+        lines.append('\t\t"res/shaders/{}",'.format(f))
+        for stage in STAGES:
+            lines.append("\t\t{},".format(literal(sources[stage])))
+        lines.append("\t},")
+    lines += [
+        "};",
+        "",
+        "inline constexpr const EmbeddedShader& GetEmbeddedShader(EmbeddedShaderID id)",
+        "{",
+        "\treturn s_EmbeddedShaders[(int)id];",
+        "}",
+        "",
+    ]
+    text = "\n".join(lines)
+
+    # Only touch the header when it changes so the build doesn't recompile everything including it
+    if os.path.exists(output):
+        with open(output, "r", encoding="utf-8") as f:
+            if f.read() == text:
+                return 0
+    with open(output, "w", encoding="utf-8", newline="\n") as f:
+        f.write(text)
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())